@@ -1,5 +1,38 @@
 #pragma once
 
+// NOTE: SSE2 is always available on x64, and on x86 when it's enabled
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DIVALIB_SSE2
+#endif
+
+#include <string.h>
+#include <type_traits>
+
+// NOTE: std::bit_cast is C++20, but the compiler builtin behind it is available in C++17
+//       mode as well, which keeps bit casts usable in constant expressions
+#if defined(_MSC_VER) && !defined(__clang__)
+#define DIVALIB_BUILTIN_BIT_CAST
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define DIVALIB_BUILTIN_BIT_CAST
+#endif
+#endif
+
+template <typename To, typename From>
+constexpr To BitCast(const From& value)
+{
+	static_assert(sizeof(To) == sizeof(From), "Types must have the same size");
+	static_assert(std::is_trivially_copyable_v<To> && std::is_trivially_copyable_v<From>, "Types must be trivially copyable");
+
+#ifdef DIVALIB_BUILTIN_BIT_CAST
+	return __builtin_bit_cast(To, value);
+#else
+	To result = { };
+	memcpy(&result, &value, sizeof(To));
+	return result;
+#endif
+}
+
 class NonCopyable
 {
 public:
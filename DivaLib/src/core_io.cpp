@@ -2,6 +2,30 @@
 #include "core_io.h"
 #include "util_string.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+#ifdef DIVALIB_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 // IO utilities
 size_t IO::Util::Align(size_t value, size_t alignment)
 {
@@ -11,6 +35,60 @@ size_t IO::Util::Align(size_t value, size_t alignment)
 	return value;
 }
 
+// Byte order
+void IO::Endian::SwapArray16(void* data, size_t count)
+{
+	uint8_t* bytes = static_cast<uint8_t*>(data);
+	size_t i = 0;
+
+#ifdef DIVALIB_SSE2
+	// NOTE: Swap the bytes of 8 values at a time
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i* ptr = reinterpret_cast<__m128i*>(&bytes[i * 2]);
+		__m128i v = _mm_loadu_si128(ptr);
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(ptr, v);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		uint16_t value;
+		memcpy(&value, &bytes[i * 2], 2);
+		value = Swap(value);
+		memcpy(&bytes[i * 2], &value, 2);
+	}
+}
+
+void IO::Endian::SwapArray32(void* data, size_t count)
+{
+	uint8_t* bytes = static_cast<uint8_t*>(data);
+	size_t i = 0;
+
+#ifdef DIVALIB_SSE2
+	// NOTE: Swap the bytes of each 16-bit half, then swap the halves.
+	//       Processes 4 values at a time
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i* ptr = reinterpret_cast<__m128i*>(&bytes[i * 4]);
+		__m128i v = _mm_loadu_si128(ptr);
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		_mm_storeu_si128(ptr, v);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		uint32_t value;
+		memcpy(&value, &bytes[i * 4], 4);
+		value = Swap(value);
+		memcpy(&bytes[i * 4], &value, 4);
+	}
+}
+
 // Path manipulation
 std::string IO::Path::GetFilename(std::string_view path)
 {
@@ -30,95 +108,43 @@ std::string IO::Path::GetFilename(std::string_view path)
 	return filename;
 }
 
-struct SegmentInfo
-{
-	size_t Position = 0;
-	size_t Size = 0;
-};
-
-static bool GetSegmentInfo(std::string_view path, std::vector<SegmentInfo>* outSegInfo, size_t* outCount)
-{
-	if (path.empty())
-		return false;
-
-	int32_t count = 1;
-	size_t lastPosition = 0;
-	size_t lastPositionEnd = 0;
-	for (size_t idx = 0; idx < path.size(); idx++)
-	{
-		// NOTE: Check if the character is a path separator and if its not the
-		//       first character in the path (UNIX absolute paths)
-		if (IO::Path::IsPathSeparator(path.at(idx)) && idx > 0)
-		{
-			// NOTE: Check if this isn't the last character in the path and
-			//       then check if the next character isn't a path separator
-			if (idx + 1 < path.size() && !IO::Path::IsPathSeparator(path.at(idx + 1)))
-			{
-				// NOTE: If all these checks are successful, store the
-				//       segment data
-				if (outSegInfo != nullptr)
-					outSegInfo->push_back({ lastPosition, lastPositionEnd - lastPosition + 1 });
-				lastPosition = idx + 1;
-				count++;
-			}
-		}
-
-		if (!IO::Path::IsPathSeparator(path.at(idx)))
-			lastPositionEnd = idx;
-
-		// NOTE: Add the last part of the path to the segments list
-		//       if we've reached the last character in the path
-		if (idx == path.size() - 1)
-			if (outSegInfo != nullptr)
-				outSegInfo->push_back({ lastPosition, lastPositionEnd - lastPosition + 1 });
-	}
-
-	if (outCount != nullptr)
-		*outCount = count;
-	return true;
-}
-
 size_t IO::Path::GetSegmentCount(std::string_view path)
 {
+	PathView segments(path);
+
 	size_t count = 0;
-	GetSegmentInfo(path, nullptr, &count);
+	for (auto it = segments.begin(); it != segments.end(); ++it)
+		count++;
 	return count;
 }
 
-static std::string GetSegmentRange(std::string_view path, size_t startIndex, size_t endIndex)
+std::string IO::Path::GetSegment(std::string_view path, int32_t segmentIndex)
 {
-	if (path.empty())
-		return std::string();
-
-	std::vector<SegmentInfo> segsInfo;
-	size_t count = 0;
-	GetSegmentInfo(path, &segsInfo, &count);
-
-	if (startIndex >= count || endIndex >= count)
-		return std::string();
-
-	if (startIndex == endIndex)
-		return std::string(&path[segsInfo[startIndex].Position], segsInfo[startIndex].Size);
-
-	std::string pathRanged;
-	for (size_t idx = startIndex; idx <= endIndex; idx++)
+	int32_t index = 0;
+	for (std::string_view segment : PathView(path))
 	{
-		pathRanged += std::string(&path[segsInfo[idx].Position], segsInfo[idx].Size);
-		if (idx < endIndex)
-			pathRanged += "/";
+		if (index++ == segmentIndex)
+			return std::string(segment);
 	}
 
-	return pathRanged;
-}
-
-std::string IO::Path::GetSegment(std::string_view path, int32_t segmentIndex)
-{
-	return GetSegmentRange(path, segmentIndex, segmentIndex);
+	return std::string();
 }
 
 std::string IO::Path::GetUntilSegment(std::string_view path, int32_t lastSegIndex)
 {
-	return GetSegmentRange(path, 0, lastSegIndex);
+	std::string pathRanged;
+	int32_t index = 0;
+	for (std::string_view segment : PathView(path))
+	{
+		if (index > 0)
+			pathRanged += "/";
+		pathRanged += segment;
+
+		if (index++ == lastSegIndex)
+			return pathRanged;
+	}
+
+	return std::string();
 }
 
 std::string IO::Path::Combine(std::string_view left, std::string_view right)
@@ -128,60 +154,207 @@ std::string IO::Path::Combine(std::string_view left, std::string_view right)
 
 namespace Helper
 {
-	static inline size_t GetPosition(FILE* file) { return (size_t)ftell(file); }
-	static inline void SetPosition(FILE* file, size_t pos) { fseek(file, pos, SEEK_SET); }
+	// NOTE: Paths aren't guaranteed to be null-terminated
+	static FILE* OpenFile(std::string_view path, const char* mode)
+	{
+		std::string filename(path);
+#ifdef _MSC_VER
+		FILE* file = nullptr;
+		return fopen_s(&file, filename.c_str(), mode) == 0 ? file : nullptr;
+#else
+		return fopen(filename.c_str(), mode);
+#endif
+	}
 
-	static size_t GetFileSize(FILE* file)
+	static bool IsDirectory(const char* path)
 	{
-		size_t position = GetPosition(file);
+#ifdef _WIN32
+		DWORD attrib = GetFileAttributesA(path);
+		if (attrib != INVALID_FILE_ATTRIBUTES)
+			return (attrib & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		return false;
+#else
+		struct stat info;
+		if (stat(path, &info) != 0)
+			return false;
+		return S_ISDIR(info.st_mode);
+#endif
+	}
 
-		fseek(file, 0, SEEK_END);
-		size_t size = GetPosition(file);
-		SetPosition(file, position);
+	// NOTE: Same as mkdir -p, a directory that already exists is fine
+	static bool MakeDirectory(const char* path)
+	{
+#ifdef _WIN32
+		if (CreateDirectoryA(path, nullptr) != 0)
+			return true;
+#else
+		if (mkdir(path, 0755) == 0)
+			return true;
+#endif
+		return IsDirectory(path);
+	}
+
+#ifdef _WIN32
+	// NOTE: ftell returns a long, which is only 32-bit on Windows
+	static bool GetFileSize(FILE* file, uint64_t* outSize)
+	{
+		struct _stat64 info;
+		if (_fstat64(_fileno(file), &info) != 0)
+			return false;
+
+		*outSize = static_cast<uint64_t>(info.st_size);
+		return true;
+	}
+#else
+	// NOTE: pread can return less than requested (it's capped at ~2 GB
+	//       on Linux), so keep going until everything has been read
+	static bool ReadAll(int fd, uint8_t* buffer, size_t size)
+	{
+		size_t total = 0;
+		while (total < size)
+		{
+			size_t chunk = std::min<size_t>(size - total, SSIZE_MAX);
+			ssize_t result = pread(fd, buffer + total, chunk, static_cast<off_t>(total));
+			if (result < 0 && errno == EINTR)
+				continue;
+			if (result <= 0)
+				return false;
+
+			total += static_cast<size_t>(result);
+		}
 
-		return size;
+		return true;
 	}
+#endif
 }
 
 // TODO: Make a function to narrow std::string_view to null-terminated std::string
 IO::FileBuffer IO::File::ReadAllData(std::string_view path, bool nullTerminated)
 {
-	// Attempt to open file
-	FILE* handle = nullptr;
-	fopen_s(&handle, path.data(), "rb");
-
-	// Attempt to read all of it's data
 	FileBuffer buffer = { };
 
-	if (handle != nullptr)
-	{
-		// Retrieve file size
-		size_t fileSize = Helper::GetFileSize(handle);
-		size_t size = nullTerminated ? fileSize + 1 : fileSize;
-		// Create buffer
-		buffer.Content = std::make_unique<uint8_t[]>(size);
-		buffer.Size = fileSize;
-		// Read all file data into the buffer
-		fread(buffer.Content.get(), fileSize, 1, handle);
-		if (nullTerminated)
-			buffer.Content[fileSize] = 0x00;
-		// Close disk file
+#ifdef _WIN32
+	// Attempt to open file
+	FILE* handle = Helper::OpenFile(path, "rb");
+	if (handle == nullptr)
+		return buffer;
+
+	// Retrieve file size
+	uint64_t fileSize = 0;
+	if (!Helper::GetFileSize(handle, &fileSize) || fileSize >= SIZE_MAX)
+	{
 		fclose(handle);
+		return buffer;
 	}
+#else
+	std::string filename(path);
+	int handle = open(filename.c_str(), O_RDONLY);
+	if (handle < 0)
+		return buffer;
+
+	struct stat info;
+	if (fstat(handle, &info) != 0 || static_cast<uint64_t>(info.st_size) >= SIZE_MAX)
+	{
+		close(handle);
+		return buffer;
+	}
+
+	uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+#endif
+
+	// Create buffer
+	size_t size = nullTerminated ? fileSize + 1 : fileSize;
+	buffer.Content = std::make_unique<uint8_t[]>(size);
+	buffer.Size = fileSize;
+
+	// Read all file data into the buffer
+#ifdef _WIN32
+	bool result = fread(buffer.Content.get(), buffer.Size, 1, handle) == 1 || buffer.Size == 0;
+	fclose(handle);
+#else
+	bool result = Helper::ReadAll(handle, buffer.Content.get(), buffer.Size);
+	close(handle);
+#endif
+
+	if (!result)
+		return FileBuffer{ };
+
+	if (nullTerminated)
+		buffer.Content[fileSize] = 0x00;
 
 	return buffer;
 }
 
-bool IO::File::Exists(std::string_view path)
+void IO::File::ReadAllDataBatch(const std::vector<std::string>& paths, const BatchCallback& callback, bool nullTerminated, size_t threadCount)
 {
-	FILE* handle = nullptr;
-	if (fopen_s(&handle, path.data(), "rb") == 0)
+	if (paths.empty())
+		return;
+
+	// NOTE: Small reads are bound by latency rather than bandwidth,
+	//       so it pays off to have more of them in flight than cores
+	if (threadCount == 0)
+		threadCount = std::max<size_t>(std::thread::hardware_concurrency() * 2, 4);
+	threadCount = std::min(threadCount, paths.size());
+
+	std::atomic<size_t> nextIndex = 0;
+	std::mutex mutex;
+	std::condition_variable completed;
+	std::vector<std::pair<size_t, FileBuffer>> results;
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++)
 	{
-		fclose(handle);
-		return true;
+		workers.emplace_back([&]()
+		{
+			for (size_t index = nextIndex++; index < paths.size(); index = nextIndex++)
+			{
+				FileBuffer buffer = ReadAllData(paths[index], nullTerminated);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				results.emplace_back(index, std::move(buffer));
+				completed.notify_one();
+			}
+		});
 	}
 
-	return false;
+	// NOTE: Hand results over in batches so the workers aren't
+	//       blocked while the callback runs
+	std::vector<std::pair<size_t, FileBuffer>> ready;
+	size_t delivered = 0;
+	while (delivered < paths.size())
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			completed.wait(lock, [&results]() { return !results.empty(); });
+			ready.swap(results);
+		}
+
+		for (auto& result : ready)
+			callback(result.first, std::move(result.second));
+
+		delivered += ready.size();
+		ready.clear();
+	}
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+bool IO::File::Exists(std::string_view path)
+{
+	std::string filename(path);
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_stat64(filename.c_str(), &info) != 0)
+		return false;
+	return (info.st_mode & _S_IFDIR) == 0;
+#else
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0)
+		return false;
+	return !S_ISDIR(info.st_mode);
+#endif
 }
 
 bool IO::Directory::Create(std::string_view path)
@@ -189,14 +362,35 @@ bool IO::Directory::Create(std::string_view path)
 	if (path.empty())
 		return false;
 
-	size_t segCount = Path::GetSegmentCount(path);
-	for (size_t i = 0; i < segCount; i++)
+	// NOTE: Each parent directory is created by null-terminating the
+	//       path in place, so it only has to be copied once
+	char stackBuffer[0x200];
+	std::unique_ptr<char[]> heapBuffer;
+	char* buffer = stackBuffer;
+	if (path.size() >= sizeof(stackBuffer))
+	{
+		heapBuffer = std::make_unique<char[]>(path.size() + 1);
+		buffer = heapBuffer.get();
+	}
+
+	// NOTE: Both kinds of separators are accepted, but only '/' works everywhere
+	for (size_t i = 0; i < path.size(); i++)
+		buffer[i] = Path::IsPathSeparator(path[i]) ? '/' : path[i];
+	buffer[path.size()] = '\0';
+
+	Path::PathView segments({ buffer, path.size() });
+	for (auto it = segments.begin(); it != segments.end(); ++it)
 	{
-		std::string curDir = Path::GetUntilSegment(path, i);
-		if (Path::IsDrive(curDir) || Directory::Exists(curDir))
+		const size_t end = it.GetEnd();
+		if (it == segments.begin() && Path::IsDrive(std::string_view(buffer, end)))
 			continue;
 
-		if (CreateDirectoryA(curDir.c_str(), nullptr) == 0)
+		const char separator = buffer[end];
+		buffer[end] = '\0';
+		bool result = Helper::MakeDirectory(buffer);
+		buffer[end] = separator;
+
+		if (!result)
 			return false;
 	}
 
@@ -205,14 +399,95 @@ bool IO::Directory::Create(std::string_view path)
 
 bool IO::Directory::Exists(std::string_view path)
 {
-	DWORD attrib = GetFileAttributesA(path.data());
-	if (attrib != INVALID_FILE_ATTRIBUTES)
-		return (attrib & FILE_ATTRIBUTE_DIRECTORY) != 0;
-	return false;
+	std::string dirname(path);
+	return Helper::IsDirectory(dirname.c_str());
+}
+
+bool IO::MappedFile::Open(std::string_view path)
+{
+	Close();
+
+#ifdef _WIN32
+	std::string filename(path);
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize = { };
+	if (GetFileSizeEx(file, &fileSize) == 0 || fileSize.QuadPart < 1 || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	// NOTE: The view keeps the mapping alive, so the handles aren't needed anymore
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	CloseHandle(file);
+
+	if (view == nullptr)
+		return false;
+
+	mData = static_cast<const uint8_t*>(view);
+	mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+	std::string filename(path);
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info = { };
+	if (fstat(fd, &info) != 0 || info.st_size < 1 || static_cast<uint64_t>(info.st_size) > SIZE_MAX)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// NOTE: The mapping stays valid after the descriptor is closed
+	close(fd);
+
+	if (view == MAP_FAILED)
+		return false;
+
+	mData = static_cast<const uint8_t*>(view);
+	mSize = static_cast<size_t>(info.st_size);
+#endif
+
+	return true;
+}
+
+void IO::MappedFile::Close()
+{
+	if (mData == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mData);
+#else
+	munmap(const_cast<uint8_t*>(mData), mSize);
+#endif
+
+	mData = nullptr;
+	mSize = 0;
 }
 
 void IO::MemoryReader::FromFile(std::string_view path)
 {
+	Reset();
+
+	// Try mapping the file first so no data is copied
+	if (mMapping.Open(path))
+	{
+		mData = mMapping.GetData();
+		mSize = mMapping.GetSize();
+		return;
+	}
+
+	// Fallback to reading the whole file
 	FileBuffer buffer = File::ReadAllData(path);
 
 	// Initialize
@@ -221,49 +496,118 @@ void IO::MemoryReader::FromFile(std::string_view path)
 		// Move read content to this instance
 		mContent = std::move(buffer.Content);
 		// Initialize other variables
+		mData = mContent.get();
 		mSize = buffer.Size;
-		mPosition = 0;
 	}
 	else
 		printf("[MemoryReader::OpenFile] File (%s) does not exist.\n", path.data());
 }
 
+void IO::MemoryReader::FromMemory(const void* data, size_t size)
+{
+	Reset();
+
+	if (data == nullptr)
+		return;
+
+	mData = static_cast<const uint8_t*>(data);
+	mSize = size;
+}
+
+bool IO::MemoryReader::FromReader(const IO::MemoryReader& parent, size_t offset, size_t size)
+{
+	if (offset > parent.mSize || size > parent.mSize - offset)
+		return false;
+
+	FromMemory(parent.mData + offset, size);
+	mEndianness = parent.mEndianness;
+	return true;
+}
+
+void IO::MemoryReader::Reset()
+{
+	// Release previous contents
+	mMapping.Close();
+	mContent.reset();
+	BaseOffsets.clear();
+	mData = nullptr;
+	mSize = 0;
+	mPosition = 0;
+}
+
 bool IO::MemoryReader::Read(void* buffer, size_t size)
 {
 	if (mPosition + size > mSize)
 		return false;
 
 	// Copy source data to the destination buffer
-	memcpy(buffer, &mContent[mPosition], size);
+	memcpy(buffer, &mData[mPosition], size);
 	// Advance read head position
 	mPosition += size;
 	return true;
 }
 
-std::string IO::MemoryReader::ReadString()
+std::string_view IO::MemoryReader::ReadStringView()
 {
-	std::string str;
-	char c = '\0';
-	do
+	if (mPosition >= mSize)
+		return std::string_view();
+
+	// Find null terminator
+	const char* begin = reinterpret_cast<const char*>(&mData[mPosition]);
+	const char* end = static_cast<const char*>(memchr(begin, '\0', mSize - mPosition));
+	size_t length = end != nullptr ? static_cast<size_t>(end - begin) : mSize - mPosition;
+
+	// Skip string and its terminator
+	mPosition += end != nullptr ? length + 1 : length;
+
+	std::string_view str(begin, length);
+	return mStringPool != nullptr ? mStringPool->Intern(str) : str;
+}
+
+void* IO::Arena::Allocate(size_t size, size_t alignment)
+{
+	size_t padding = (alignment - reinterpret_cast<uintptr_t>(mBlockPosition) % alignment) % alignment;
+	if (mBlockPosition == nullptr || padding + size > mBlockRemaining)
 	{
-		c = ReadChar();
-		str += c;
-	} while (c != '\0');
+		// NOTE: Blocks are allocated with the default new alignment
+		size_t blockSize = size > mBlockSize ? size : mBlockSize;
+		mBlocks.push_back(std::make_unique<uint8_t[]>(blockSize));
+		mBlockPosition = mBlocks.back().get();
+		mBlockRemaining = blockSize;
+		padding = 0;
+	}
 
-	return str;
+	void* data = mBlockPosition + padding;
+	mBlockPosition += padding + size;
+	mBlockRemaining -= padding + size;
+	return data;
+}
+
+void IO::Arena::Reset()
+{
+	mBlocks.clear();
+	mBlockPosition = nullptr;
+	mBlockRemaining = 0;
 }
 
-void IO::MemoryReader::ReadAtOffset(size_t offset, std::function<void(IO::MemoryReader&)> task, bool useBaseOffset)
+std::string_view IO::StringPool::Intern(std::string_view str)
 {
-	// Get current position
-	size_t pos = GetPosition();
+	auto it = mStrings.find(str);
+	if (it != mStrings.end())
+		return *it;
 
-	// Execute work at offset
-	SeekBegin(useBaseOffset && BaseOffsets.size() > 0 ? offset + BaseOffsets.back() : offset);
-	task(*this);
+	// NOTE: Strings are null-terminated so they can be used as C strings too
+	char* data = static_cast<char*>(mArena.Allocate(str.size() + 1, 1));
+	memcpy(data, str.data(), str.size());
+	data[str.size()] = '\0';
 
-	// Seek back to current position;
-	SeekBegin(pos);
+	return *mStrings.emplace(data, str.size()).first;
+}
+
+void IO::StringPool::Clear()
+{
+	mStrings.clear();
+	mArena.Reset();
 }
 
 bool IO::MemoryWriter::Write(const void* buffer, size_t size)
@@ -271,47 +615,281 @@ bool IO::MemoryWriter::Write(const void* buffer, size_t size)
 	if (size < 1 || buffer == nullptr)
 		return false;
 
-	while (mPosition + size > mCapacity)
-		ExpandBuffer();
+	// NOTE: Data before the base was already streamed to disk
+	if (mPosition < mBase)
+	{
+		size_t streamed = mBase - mPosition < size ? mBase - mPosition : size;
+		if (!WriteStreamed(mPosition, buffer, streamed))
+		{
+			mStreamFailed = true;
+			return false;
+		}
+
+		mPosition += streamed;
+		if (streamed == size)
+			return true;
+
+		buffer = static_cast<const uint8_t*>(buffer) + streamed;
+		size -= streamed;
+	}
+
+	// NOTE: Writing before the last extent (e.g. patching offsets) takes the slow path
+	if (!mExtents.empty() && mPosition < mExtents.back().Position + mExtents.back().Size)
+		return WriteInExtents(buffer, size);
+
+	const size_t ownPosition = mPosition - mBase - mExtentSize;
+	if (ownPosition + size > mCapacity)
+	{
+		ExpandBuffer(ownPosition + size);
+		if (ownPosition + size > mCapacity)
+			return false;
+	}
 
-	memcpy(&mContent[mPosition], buffer, size);
+	memcpy(&mContent[ownPosition], buffer, size);
 	if (mPosition + size > mSize)
 		mSize += mPosition + size - mSize;
 	mPosition += size;
 
+	if (mStream != nullptr && GetOwnSize() >= mWindowSize)
+		return Spill();
+
 	return true;
 }
 
-void IO::MemoryWriter::ScheduleWrite(std::function<void(IO::MemoryWriter&)> task)
+bool IO::MemoryWriter::WriteInExtents(const void* buffer, size_t size)
 {
-	auto& schedule = ScheduledWrites.emplace_back();
-	schedule.Task = task;
+	// Find the first extent after the current position
+	auto next = std::upper_bound(mExtents.begin(), mExtents.end(), mPosition,
+		[](size_t pos, const Extent& ext) { return pos < ext.Position; });
+
+	size_t ownPosition = mPosition - mBase;
+	if (next != mExtents.begin())
+	{
+		const Extent& prev = *(next - 1);
+		const size_t prevEnd = prev.Position + prev.Size;
+
+		// NOTE: Spliced data is read-only
+		if (mPosition < prevEnd)
+			return false;
+
+		ownPosition = prev.OwnPosition + (mPosition - prevEnd);
+	}
+
+	// NOTE: Writes can't cross into the next extent either
+	if (next != mExtents.end() && mPosition + size > next->Position)
+		return false;
+
+	memcpy(&mContent[ownPosition], buffer, size);
+	mPosition += size;
+	return true;
 }
 
-void IO::MemoryWriter::ScheduleWriteOffset(std::function<void(IO::MemoryWriter&)> task, size_t baseOffset)
+bool IO::MemoryWriter::Reserve(size_t size)
 {
-	auto& schedule = ScheduledWrites.emplace_back();
-	schedule.Task = task;
-	schedule.OffsetPosition = GetPosition();
-	schedule.BaseOffset = baseOffset;
-	WriteUInt32(0);
+	if (size <= mCapacity)
+		return true;
+
+	auto cont = std::make_unique<uint8_t[]>(size);
+	if (cont == nullptr)
+		return false;
+
+	if (mContent != nullptr)
+		memcpy(cont.get(), mContent.get(), GetOwnSize());
+	mContent = std::move(cont);
+	mCapacity = size;
+	return true;
 }
 
-void IO::MemoryWriter::ScheduleWriteOffsetAndSize(std::function<void(IO::MemoryWriter&)> task, size_t baseOffset)
+void IO::MemoryWriter::Splice(const void* data, size_t size)
 {
-	auto& schedule = ScheduledWrites.emplace_back();
-	schedule.Task = task;
-	schedule.BaseOffset = baseOffset;
-	schedule.OffsetPosition = GetPosition();
-	WriteUInt32(0);
-	schedule.SizePosition = GetPosition();
-	WriteUInt32(0);
+	if (size < 1 || data == nullptr)
+		return;
+
+	SeekEnd(0);
+
+	Extent& ext = mExtents.emplace_back();
+	ext.Position = mSize;
+	ext.OwnPosition = GetOwnSize();
+	ext.Size = size;
+	ext.Data = static_cast<const uint8_t*>(data);
+
+	mSize += size;
+	mExtentSize += size;
+	mPosition = mSize;
+
+	// NOTE: Spliced data goes straight to disk when streaming
+	if (mStream != nullptr)
+		Spill();
+}
+
+void IO::MemoryWriter::Splice(IO::MemoryWriter&& other)
+{
+	if (&other == this || other.mSize < 1)
+		return;
+
+	SeekEnd(0);
+
+	const size_t ownPosition = GetOwnSize();
+	std::unique_ptr<uint8_t[]> otherContent = std::move(other.mContent);
+	const uint8_t* otherData = otherContent.get();
+
+	// NOTE: Pieces of the other writer's own buffer become extents pointing into it,
+	//       the first of them keeps the buffer alive
+	auto pushOwn = [&](size_t offset, size_t size)
+	{
+		Extent& ext = mExtents.emplace_back();
+		ext.Position = mSize;
+		ext.OwnPosition = ownPosition;
+		ext.Size = size;
+		ext.Data = otherData + offset;
+		if (otherContent != nullptr)
+			ext.Content = std::move(otherContent);
+
+		mSize += size;
+		mExtentSize += size;
+	};
+
+	size_t own = 0;
+	for (Extent& otherExt : other.mExtents)
+	{
+		if (otherExt.OwnPosition > own)
+			pushOwn(own, otherExt.OwnPosition - own);
+		own = otherExt.OwnPosition;
+
+		otherExt.Position = mSize;
+		otherExt.OwnPosition = ownPosition;
+		mSize += otherExt.Size;
+		mExtentSize += otherExt.Size;
+		mExtents.push_back(std::move(otherExt));
+	}
+
+	if (other.GetOwnSize() > own)
+		pushOwn(own, other.GetOwnSize() - own);
+
+	mPosition = mSize;
+	if (mStream != nullptr)
+		Spill();
+
+	// Leave the other writer empty
+	other.mExtents.clear();
+	other.mExtentSize = 0;
+	other.mSize = 0;
+	other.mPosition = 0;
+	other.mCapacity = 0;
+}
+
+void IO::MemoryWriter::Linearize()
+{
+	if (mExtents.empty())
+		return;
+
+	const size_t size = mSize - mBase;
+	auto cont = std::make_unique<uint8_t[]>(size > mCapacity ? size : mCapacity);
+	size_t pos = 0;
+	VisitSegments([&cont, &pos](const uint8_t* data, size_t size)
+	{
+		memcpy(&cont[pos], data, size);
+		pos += size;
+	});
+
+	mContent = std::move(cont);
+	mCapacity = size > mCapacity ? size : mCapacity;
+	mExtents.clear();
+	mExtentSize = 0;
+}
+
+bool IO::MemoryWriter::OpenStream(std::string_view path, size_t windowSize)
+{
+	CloseStream();
+
+	mStream = Helper::OpenFile(path, "wb");
+	if (mStream == nullptr)
+		return false;
+
+	mWindowSize = windowSize;
+	mStreamFailed = false;
+	// NOTE: Write out anything that was written before opening the stream
+	return Spill();
+}
+
+bool IO::MemoryWriter::CloseStream()
+{
+	if (mStream == nullptr)
+		return false;
+
+	bool result = Spill();
+	result = fclose(mStream) == 0 && result && !mStreamFailed;
+	mStream = nullptr;
+
+	// NOTE: The written data isn't available anymore
+	ClearScheduledWrites();
+	ScheduledStrings.clear();
+	BaseOffsets.clear();
+	mSize = 0;
+	mPosition = 0;
+	mBase = 0;
+	return result;
+}
+
+bool IO::MemoryWriter::Spill()
+{
+	bool result = true;
+	VisitSegments([this, &result](const uint8_t* data, size_t size)
+	{
+		if (result && fwrite(data, size, 1, mStream) != 1)
+			result = false;
+	});
+
+	// NOTE: Reuse the buffer for the next window
+	mBase = mSize;
+	mExtents.clear();
+	mExtentSize = 0;
+
+	if (!result)
+		mStreamFailed = true;
+	return result;
+}
+
+bool IO::MemoryWriter::WriteStreamed(size_t position, const void* buffer, size_t size)
+{
+	if (mStream == nullptr)
+		return false;
+
+#ifdef _WIN32
+	if (_fseeki64(mStream, static_cast<int64_t>(position), SEEK_SET) != 0)
+		return false;
+
+	bool result = fwrite(buffer, size, 1, mStream) == 1;
+	_fseeki64(mStream, 0, SEEK_END);
+	return result;
+#else
+	// NOTE: pwrite doesn't move the file position, so appending keeps working
+	fflush(mStream);
+
+	const uint8_t* data = static_cast<const uint8_t*>(buffer);
+	while (size > 0)
+	{
+		ssize_t written = pwrite(fileno(mStream), data, size, static_cast<off_t>(position));
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		data += written;
+		position += static_cast<size_t>(written);
+		size -= static_cast<size_t>(written);
+	}
+
+	return true;
+#endif
 }
 
 void IO::MemoryWriter::ScheduleWriteStringOffset(const std::string_view data, size_t baseOffset)
 {
 	auto& schedule = ScheduledStrings.emplace_back();
-	schedule.Data = std::string(data);
+	schedule.Data = data;
 	schedule.OffsetPosition = GetPosition();
 	schedule.BaseOffset = baseOffset;
 	WriteUInt32(0);
@@ -322,67 +900,228 @@ void IO::MemoryWriter::FlushScheduledWrites()
 	// NOTE: Make sure we're at the end of the file
 	SeekEnd(0);
 
-	for (const auto& schedule : ScheduledWrites)
+	// NOTE: Tasks may schedule more writes, which are resolved in this same pass.
+	//       The record is copied since that can reallocate the list
+	for (size_t i = 0; i < ScheduledWrites.size(); i++)
 	{
+		const ScheduledWrite schedule = ScheduledWrites[i];
 		const size_t pos = GetPosition();
 		const size_t offset = pos - schedule.BaseOffset;
 
-		if (schedule.OffsetPosition > -1)
+		if (schedule.OffsetPosition != NoPosition)
 		{
 			Seek(schedule.OffsetPosition);
 			WriteUInt32(static_cast<uint32_t>(offset));
 		}
 
 		Seek(pos);
-		schedule.Task(*this);
+		schedule.Invoke(schedule.Task, *this);
+		if (schedule.Destroy != nullptr)
+			schedule.Destroy(schedule.Task);
+		ScheduledWrites[i].Destroy = nullptr;
 
-		if (schedule.SizePosition > -1)
+		if (schedule.SizePosition != NoPosition)
 		{
 			size_t size = GetPosition() - pos;
 			Seek(schedule.SizePosition);
-			WriteUInt32(size);
+			WriteUInt32(static_cast<uint32_t>(size));
 		}
 
 		SeekEnd(0);
 	}
 
 	ScheduledWrites.clear();
+	mScheduleArena.Reset();
 }
 
-void IO::MemoryWriter::FlushScheduledStrings()
+void IO::MemoryWriter::ClearScheduledWrites()
+{
+	for (const auto& schedule : ScheduledWrites)
+		if (schedule.Destroy != nullptr)
+			schedule.Destroy(schedule.Task);
+
+	ScheduledWrites.clear();
+	mScheduleArena.Reset();
+}
+
+void IO::MemoryWriter::FlushScheduledStrings(StringPooling pooling)
 {
 	SeekEnd(0);
 
-	for (auto& schedule : ScheduledStrings)
+	if (pooling == StringPooling::None)
+	{
+		for (const auto& schedule : ScheduledStrings)
+		{
+			if (schedule.OffsetPosition == NoPosition)
+				continue;
+
+			size_t pos = GetPosition();
+			WriteString(schedule.Data);
+			Seek(schedule.OffsetPosition);
+			WriteUInt32(pos - schedule.BaseOffset);
+			SeekEnd(0);
+		}
+
+		ScheduledStrings.clear();
+		return;
+	}
+
+	// Find unique strings, in order of first use
+	std::unordered_map<std::string_view, size_t> indices;
+	std::vector<std::string_view> unique;
+	std::vector<size_t> stringIndices(ScheduledStrings.size());
+	indices.reserve(ScheduledStrings.size());
+
+	for (size_t i = 0; i < ScheduledStrings.size(); i++)
 	{
-		if (schedule.OffsetPosition < 0)
+		auto result = indices.try_emplace(ScheduledStrings[i].Data, unique.size());
+		if (result.second)
+			unique.push_back(ScheduledStrings[i].Data);
+		stringIndices[i] = result.first->second;
+	}
+
+	// NOTE: Each unique string is written as part of its owner,
+	//       which is either itself or a string it's a suffix of
+	std::vector<size_t> owners(unique.size());
+	std::iota(owners.begin(), owners.end(), 0);
+
+	if (pooling == StringPooling::Suffixes)
+	{
+		// NOTE: Sorted by their reverse, a string that ends another one
+		//       always comes right before one that it's a suffix of
+		std::vector<size_t> order(unique.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&unique](size_t left, size_t right)
+		{
+			const auto& l = unique[left];
+			const auto& r = unique[right];
+			return std::lexicographical_compare(l.rbegin(), l.rend(), r.rbegin(), r.rend());
+		});
+
+		// NOTE: Walks the pairs from the back, so owners pass down whole suffix chains.
+		//       Counting down to 1 keeps this from wrapping when there are no strings
+		for (size_t i = order.size(); i-- > 1;)
+		{
+			std::string_view str = unique[order[i - 1]];
+			std::string_view next = unique[order[i]];
+			if (next.size() >= str.size() && next.compare(next.size() - str.size(), str.size(), str) == 0)
+				owners[order[i - 1]] = owners[order[i]];
+		}
+	}
+
+	// Write owner strings
+	std::vector<size_t> positions(unique.size(), NoPosition);
+	for (size_t i = 0; i < unique.size(); i++)
+	{
+		if (owners[i] != i)
+			continue;
+
+		positions[i] = GetPosition();
+		WriteString(unique[i]);
+	}
+
+	// Point all offsets to their string
+	for (size_t i = 0; i < ScheduledStrings.size(); i++)
+	{
+		const auto& schedule = ScheduledStrings[i];
+		if (schedule.OffsetPosition == NoPosition)
 			continue;
 
-		size_t pos = GetPosition();
-		WriteString(schedule.Data);
+		const size_t index = stringIndices[i];
+		const size_t owner = owners[index];
+		const size_t pos = positions[owner] + unique[owner].size() - unique[index].size();
+
 		Seek(schedule.OffsetPosition);
 		WriteUInt32(pos - schedule.BaseOffset);
-		SeekEnd(0);
 	}
 
+	SeekEnd(0);
 	ScheduledStrings.clear();
 }
 
+#ifndef _WIN32
+static bool WriteAllVectors(int fd, iovec* vectors, size_t count)
+{
+	while (count > 0)
+	{
+		int batch = static_cast<int>(count > IOV_MAX ? IOV_MAX : count);
+		ssize_t written = writev(fd, vectors, batch);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		// Skip everything that was fully written
+		size_t remaining = static_cast<size_t>(written);
+		while (count > 0 && remaining >= vectors->iov_len)
+		{
+			remaining -= vectors->iov_len;
+			vectors++;
+			count--;
+		}
+
+		// Resume partially written vector
+		if (count > 0)
+		{
+			vectors->iov_base = static_cast<uint8_t*>(vectors->iov_base) + remaining;
+			vectors->iov_len -= remaining;
+		}
+	}
+
+	return true;
+}
+#endif
+
 bool IO::MemoryWriter::Flush(std::string_view path)
 {
-	FILE* file = nullptr;
-	fopen_s(&file, path.data(), "wb");
+	if (mStream != nullptr)
+		return false;
 
+#ifdef _WIN32
+	FILE* file = Helper::OpenFile(path, "wb");
 	if (file == nullptr)
 		return false;
 
-	fwrite(mContent.get(), mSize, 1, file);
+	bool result = true;
+	VisitSegments([file, &result](const uint8_t* data, size_t size)
+	{
+		if (result && fwrite(data, size, 1, file) != 1)
+			result = false;
+	});
 	fclose(file);
 
-	return true;
+	return result;
+#else
+	std::string filename(path);
+	int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+
+	// NOTE: Write all the segments at once without joining them
+	std::vector<iovec> vectors;
+	vectors.reserve(mExtents.size() * 2 + 1);
+	VisitSegments([&vectors](const uint8_t* data, size_t size)
+	{
+		vectors.push_back({ const_cast<uint8_t*>(data), size });
+	});
+
+	bool result = WriteAllVectors(fd, vectors.data(), vectors.size());
+	close(fd);
+
+	return result;
+#endif
 }
 
 bool IO::MemoryWriter::CopyTo(IO::MemoryWriter& destination)
 {
-	return destination.Write(mContent.get(), mSize);
-}
\ No newline at end of file
+	bool result = true;
+	VisitSegments([&destination, &result](const uint8_t* data, size_t size)
+	{
+		if (!destination.Write(data, size))
+			result = false;
+	});
+
+	return result;
+}
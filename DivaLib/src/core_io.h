@@ -2,10 +2,18 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <new>
+#include <string>
 #include <string_view>
-#include <list>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "core.h"
 #include "half.h"
 
@@ -16,42 +24,80 @@ namespace IO
 		size_t Align(size_t value, size_t alignment);
 	}
 
+	enum class Endianness
+	{
+		Little,
+		Big
+	};
+
 	namespace Endian
 	{
-		inline int16_t Swap(int16_t value)
+		// NOTE: Byte order of the machine we're running on
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		constexpr Endianness Native = Endianness::Big;
+#else
+		constexpr Endianness Native = Endianness::Little;
+#endif
+
+		// NOTE: All of these can be evaluated at compile time. MSVC's intrinsics
+		//       aren't constexpr, so they're only used when running
+		constexpr uint16_t Swap(uint16_t value)
 		{
-			return (value << 8 & 0xFF00) | (value >> 8 & 0xFF);
+#ifdef _MSC_VER
+			if (!__builtin_is_constant_evaluated())
+				return _byteswap_ushort(value);
+			return static_cast<uint16_t>((value >> 8) | (value << 8));
+#else
+			return __builtin_bswap16(value);
+#endif
 		}
 
-		inline int32_t Swap(int32_t value)
+		constexpr uint32_t Swap(uint32_t value)
 		{
-			return (value >> 24 & 0xFF) | ((value >> 16 & 0xFF) << 8) | ((value >> 8 & 0xFF) << 16) | ((value & 0xFF) << 24);
+#ifdef _MSC_VER
+			if (!__builtin_is_constant_evaluated())
+				return _byteswap_ulong(value);
+			return (value >> 24) | ((value >> 8) & 0x0000FF00) | ((value << 8) & 0x00FF0000) | (value << 24);
+#else
+			return __builtin_bswap32(value);
+#endif
 		}
 
-		// HACK!!!
-		inline uint16_t Swap(uint16_t value)
+		constexpr int16_t Swap(int16_t value) { return static_cast<int16_t>(Swap(static_cast<uint16_t>(value))); }
+		constexpr int32_t Swap(int32_t value) { return static_cast<int32_t>(Swap(static_cast<uint32_t>(value))); }
+		constexpr float Swap(float value) { return BitCast<float>(Swap(BitCast<uint32_t>(value))); }
+
+		// NOTE: Converts a value between the given byte order and the native one.
+		//       Compiles down to nothing when they're the same
+		template <Endianness E, typename T>
+		constexpr T Convert(T value)
 		{
-			int16_t temp = Swap(*(int16_t*)&value);
-			return *(uint16_t*)&temp;
+			if constexpr (E == Native)
+				return value;
+			else
+				return Swap(value);
 		}
 
-		inline uint32_t Swap(uint32_t value)
-		{ 
-			int32_t temp = Swap(*(int32_t*)&value);
-			return *(uint32_t*)&temp;
-		}
+		// NOTE: In-place swap of whole arrays, vectorized when possible
+		void SwapArray16(void* data, size_t count);
+		void SwapArray32(void* data, size_t count);
 
-		inline float Swap(float value)
+		template <typename T>
+		inline void SwapArray(T* data, size_t count)
 		{
-			float temp = 0.0f;
-			char *src = (char*)&value, *dst = (char*)&temp;
+			static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "Unsupported element size");
 
-			dst[0] = src[3];
-			dst[1] = src[2];
-			dst[2] = src[1];
-			dst[3] = src[0];
+			if constexpr (sizeof(T) == 2)
+				SwapArray16(data, count);
+			else if constexpr (sizeof(T) == 4)
+				SwapArray32(data, count);
+		}
 
-			return temp;
+		template <Endianness E, typename T>
+		inline void ConvertArray(T* data, size_t count)
+		{
+			if constexpr (E != Native)
+				SwapArray(data, count);
 		}
 	}
 
@@ -70,13 +116,58 @@ namespace IO
 				   ((path[0] > 'A' && path[0] < 'Z') || (path[0] > 'a' && path[0] < 'z')) && 
 				   (path[1] == ':');
 		}
-	}
 
-	enum class Endianness
-	{
-		Little,
-		Big
-	};
+		// NOTE: Iterates over the segments of a path without allocating. Repeated separators
+		//       are skipped and the first segment keeps the leading one of UNIX absolute paths
+		class PathView
+		{
+		public:
+			class Iterator
+			{
+			public:
+				Iterator(std::string_view path, size_t position) : mPath(path), mPosition(position), mEnd(FindEnd(path, position)) { }
+
+				inline std::string_view operator*() const { return mPath.substr(mPosition, mEnd - mPosition); }
+				// NOTE: Position right after the current segment in the path
+				inline size_t GetEnd() const { return mEnd; }
+
+				inline Iterator& operator++()
+				{
+					mPosition = mEnd;
+					while (mPosition < mPath.size() && IsPathSeparator(mPath[mPosition]))
+						mPosition++;
+
+					mEnd = FindEnd(mPath, mPosition);
+					return *this;
+				}
+
+				inline bool operator==(const Iterator& other) const { return mPosition == other.mPosition; }
+				inline bool operator!=(const Iterator& other) const { return mPosition != other.mPosition; }
+			private:
+				std::string_view mPath;
+				size_t mPosition;
+				size_t mEnd;
+
+				static inline size_t FindEnd(std::string_view path, size_t position)
+				{
+					if (position >= path.size())
+						return path.size();
+
+					size_t end = position + 1;
+					while (end < path.size() && !IsPathSeparator(path[end]))
+						end++;
+					return end;
+				}
+			};
+
+			explicit PathView(std::string_view path) : mPath(path) { }
+
+			inline Iterator begin() const { return Iterator(mPath, 0); }
+			inline Iterator end() const { return Iterator(mPath, mPath.size()); }
+		private:
+			std::string_view mPath;
+		};
+	}
 
 	struct FileBuffer
 	{
@@ -88,6 +179,15 @@ namespace IO
 	{
 		FileBuffer ReadAllData(std::string_view path, bool nullTerminated = false);
 		bool Exists(std::string_view path);
+
+		// NOTE: Called with the index of the path and its data, which is
+		//       empty if the file couldn't be read
+		using BatchCallback = std::function<void(size_t index, FileBuffer&& buffer)>;
+
+		// NOTE: Reads many files at once on worker threads, so their latency overlaps.
+		//       The callback runs on the calling thread as files complete, in no particular order.
+		//       A thread count of 0 picks one based on the hardware
+		void ReadAllDataBatch(const std::vector<std::string>& paths, const BatchCallback& callback, bool nullTerminated = false, size_t threadCount = 0);
 	}
 
 	namespace Directory
@@ -96,8 +196,69 @@ namespace IO
 		bool Exists(std::string_view path);
 	}
 
-	// WARNING: Do *not* use this with big files (such as whole data archives).
-	//          This is a memory stream, not a file stream. It will load all the data in memory
+	// NOTE: How MemoryWriter::FlushScheduledStrings shares data between strings
+	enum class StringPooling
+	{
+		None,       // Every string gets its own copy
+		Duplicates, // Equal strings are written once
+		Suffixes    // Same as above, strings that end another one point into it
+	};
+
+	// NOTE: Bump allocator. Memory is only released all at once by Reset
+	class Arena final : NonCopyable
+	{
+	public:
+		Arena() = default;
+		~Arena() = default;
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+		void Reset();
+	private:
+		std::vector<std::unique_ptr<uint8_t[]>> mBlocks;
+		uint8_t* mBlockPosition = nullptr;
+		size_t mBlockRemaining = 0;
+		const size_t mBlockSize = 64 * 1024; // 64kb
+	};
+
+	// NOTE: Keeps a single copy of every string added to it. The returned views
+	//       stay valid until the pool is cleared or destroyed
+	class StringPool final : NonCopyable
+	{
+	public:
+		StringPool() = default;
+		~StringPool() = default;
+
+		std::string_view Intern(std::string_view str);
+		void Clear();
+
+		inline size_t GetCount() const { return mStrings.size(); }
+	private:
+		std::unordered_set<std::string_view> mStrings;
+		Arena mArena;
+	};
+
+	// NOTE: Read-only view of a whole file mapped into memory. Pages are only
+	//       loaded by the OS when they're first touched
+	class MappedFile final : NonCopyable
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		bool Open(std::string_view path);
+		void Close();
+
+		inline bool Valid() const { return mData != nullptr; }
+		inline const uint8_t* GetData() const { return mData; }
+		inline size_t GetSize() const { return mSize; }
+	private:
+		const uint8_t* mData = nullptr;
+		size_t mSize = 0;
+	};
+
+	// NOTE: Files are memory mapped when possible, so opening big files (such as
+	//       whole data archives) only costs what is actually read from them.
+	//       If mapping fails the whole file is loaded in memory instead
 	class MemoryReader final : NonCopyable
 	{
 	public:
@@ -105,6 +266,10 @@ namespace IO
 		~MemoryReader() = default;
 
 		void FromFile(std::string_view path);
+		// NOTE: These don't copy nor take ownership of the data. The source buffer
+		//       (or parent reader) must outlive this reader
+		void FromMemory(const void* data, size_t size);
+		bool FromReader(const MemoryReader& parent, size_t offset, size_t size);
 
 		inline size_t GetPosition() { return mPosition; }
 		inline size_t GetSize() { return mSize; }
@@ -133,44 +298,177 @@ namespace IO
 		inline int8_t ReadInt8() { return Internal_ReadT<int8_t>(); }
 		inline uint8_t ReadUInt8() { return Internal_ReadT<uint8_t>(); }
 
-		inline int16_t ReadInt16() { return ShouldSwap() ? ReadI16_B() : Internal_ReadT<int16_t>(); }
-		inline uint16_t ReadUInt16() { return ShouldSwap() ? ReadU16_B() : Internal_ReadT<uint16_t>(); }
-		inline int32_t ReadInt32() { return ShouldSwap() ? ReadI32_B() : Internal_ReadT<int32_t>(); }
-		inline uint32_t ReadUInt32() { return ShouldSwap() ? ReadU32_B() : Internal_ReadT<uint32_t>(); }
-		inline float ReadFloat32() { return ShouldSwap() ? ReadF32_B() : Internal_ReadT<float>(); }
+		// NOTE: Fixed byte order reads, for formats that always use the same one
+		template <Endianness E> inline int16_t ReadInt16() { return Endian::Convert<E>(Internal_ReadT<int16_t>()); }
+		template <Endianness E> inline uint16_t ReadUInt16() { return Endian::Convert<E>(Internal_ReadT<uint16_t>()); }
+		template <Endianness E> inline int32_t ReadInt32() { return Endian::Convert<E>(Internal_ReadT<int32_t>()); }
+		template <Endianness E> inline uint32_t ReadUInt32() { return Endian::Convert<E>(Internal_ReadT<uint32_t>()); }
+		template <Endianness E> inline float ReadFloat32() { return Endian::Convert<E>(Internal_ReadT<float>()); }
+		template <Endianness E> inline float ReadFloat16() { return FLOAT16::ToFloat32(FLOAT16::FromBits(Endian::Convert<E>(Internal_ReadT<uint16_t>()))); }
+
+		inline int16_t ReadInt16() { return IsBigEndian() ? ReadInt16<Endianness::Big>() : ReadInt16<Endianness::Little>(); }
+		inline uint16_t ReadUInt16() { return IsBigEndian() ? ReadUInt16<Endianness::Big>() : ReadUInt16<Endianness::Little>(); }
+		inline int32_t ReadInt32() { return IsBigEndian() ? ReadInt32<Endianness::Big>() : ReadInt32<Endianness::Little>(); }
+		inline uint32_t ReadUInt32() { return IsBigEndian() ? ReadUInt32<Endianness::Big>() : ReadUInt32<Endianness::Little>(); }
+		inline float ReadFloat32() { return IsBigEndian() ? ReadFloat32<Endianness::Big>() : ReadFloat32<Endianness::Little>(); }
+		inline float ReadFloat16() { return IsBigEndian() ? ReadFloat16<Endianness::Big>() : ReadFloat16<Endianness::Little>(); }
+
+		// NOTE: Validation for the unchecked reads below. Formats should check
+		//       their tables (offset and count pairs) once, then read them unchecked
+		inline bool CheckRange(size_t offset, size_t size) const
+		{
+			return offset <= mSize && size <= mSize - offset;
+		}
+
+		inline bool CheckTable(size_t offset, size_t count, size_t elementSize) const
+		{
+			if (elementSize > 0 && count > SIZE_MAX / elementSize)
+				return false;
+
+			return CheckRange(offset, count * elementSize);
+		}
+
+		// NOTE: No bounds checking at all, only use inside ranges that passed
+		//       CheckRange or CheckTable
+		template <Endianness E, typename T>
+		inline T ReadUnchecked()
+		{
+			static_assert(std::is_arithmetic_v<T>, "Basic types only");
+
+			T value;
+			memcpy(&value, &mData[mPosition], sizeof(T));
+			mPosition += sizeof(T);
+
+			if constexpr (sizeof(T) == 1)
+				return value;
+			else
+				return Endian::Convert<E>(value);
+		}
+
+		template <typename T>
+		inline T ReadUnchecked()
+		{
+			return IsBigEndian() ? ReadUnchecked<Endianness::Big, T>() : ReadUnchecked<Endianness::Little, T>();
+		}
+
+		// NOTE: Reads `count` elements at once with a single bounds check
+		template <Endianness E, typename T>
+		inline bool ReadArray(T* buffer, size_t count)
+		{
+			if (count < 1)
+				return true;
+
+			if (count > SIZE_MAX / sizeof(T) || !Read(buffer, count * sizeof(T)))
+				return false;
+
+			Endian::ConvertArray<E>(buffer, count);
+			return true;
+		}
+
+		template <typename T>
+		inline bool ReadArray(T* buffer, size_t count)
+		{
+			return IsBigEndian() ? ReadArray<Endianness::Big>(buffer, count) : ReadArray<Endianness::Little>(buffer, count);
+		}
+
+		// NOTE: Reads `count` halves straight into floats. Each chunk is swapped
+		//       and converted while it's still in cache
+		template <Endianness E>
+		inline bool ReadFloat16Array(float* buffer, size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(uint16_t) || !CheckRange(mPosition, count * sizeof(uint16_t)))
+				return false;
+
+			constexpr size_t chunkCount = 0x800;
+			uint16_t chunk[chunkCount];
+
+			for (size_t i = 0; i < count; i += chunkCount)
+			{
+				size_t n = count - i < chunkCount ? count - i : chunkCount;
+				memcpy(chunk, &mData[mPosition], n * sizeof(uint16_t));
+				mPosition += n * sizeof(uint16_t);
+
+				Endian::ConvertArray<E>(chunk, n);
+				FLOAT16::ToFloat32Array(chunk, &buffer[i], n);
+			}
+
+			return true;
+		}
+
+		inline bool ReadFloat16Array(float* buffer, size_t count)
+		{
+			return IsBigEndian() ? ReadFloat16Array<Endianness::Big>(buffer, count) : ReadFloat16Array<Endianness::Little>(buffer, count);
+		}
 
 		// Read null-terminated string
-		std::string ReadString();
-		inline std::string ReadStringOffset()
+		inline std::string ReadString() { return std::string(ReadStringView()); }
+		inline std::string ReadStringOffset() { return std::string(ReadStringViewOffset()); }
+
+		// NOTE: Views point straight into the reader's data (or the string pool,
+		//       if one is set), so they're only valid while that is alive
+		std::string_view ReadStringView();
+		inline std::string_view ReadStringViewOffset()
+		{
+			auto scope = SeekScoped(ReadUInt32());
+			return ReadStringView();
+		}
+
+		// NOTE: Makes string views be interned in the given pool, so repeated
+		//       strings are only stored once and outlive this reader
+		inline void SetStringPool(StringPool* pool) { mStringPool = pool; }
+
+		// NOTE: Seeks to an offset and goes back to the previous position
+		//       once it goes out of scope
+		class SeekScope final : NonCopyable
+		{
+		public:
+			SeekScope(MemoryReader& reader, size_t offset) : mReader(reader), mPosition(reader.GetPosition()) { reader.SeekBegin(offset); }
+			~SeekScope() { mReader.SeekBegin(mPosition); }
+		private:
+			MemoryReader& mReader;
+			size_t mPosition;
+		};
+
+		[[nodiscard]] inline SeekScope SeekScoped(size_t offset, bool useBaseOffset = false)
 		{
-			std::string str;
-			ReadAtOffset(ReadUInt32(), [&str](IO::MemoryReader& reader) { str = reader.ReadString(); });
-			return str;
+			return SeekScope(*this, GetOffsetPosition(offset, useBaseOffset));
+		}
+
+		template <typename Fn>
+		inline void ReadAtOffset(size_t offset, Fn&& task, bool useBaseOffset = false)
+		{
+			SeekScope scope(*this, GetOffsetPosition(offset, useBaseOffset));
+			task(*this);
 		}
-		
-		void ReadAtOffset(size_t offset, std::function<void(IO::MemoryReader&)> task, bool useBaseOffset = false);
 	private:
 		std::vector<size_t> BaseOffsets;
 		std::unique_ptr<uint8_t[]> mContent;
+		MappedFile mMapping;
+		// NOTE: Points to either mContent or mMapping
+		const uint8_t* mData = nullptr;
 		size_t mSize = 0;
 		size_t mPosition = 0;
 		Endianness mEndianness = Endianness::Little;
+		StringPool* mStringPool = nullptr;
 
-		inline bool ShouldSwap() { return mEndianness == Endianness::Big; }
-
-		// Internal use only
-		inline int16_t ReadI16_B() { return Endian::Swap(Internal_ReadT<int16_t>()); }
-		inline uint16_t ReadU16_B() { return Endian::Swap(Internal_ReadT<uint16_t>()); }
-		inline int32_t ReadI32_B() { return Endian::Swap(Internal_ReadT<int32_t>()); }
-		inline uint32_t ReadU32_B() { return Endian::Swap(Internal_ReadT<uint32_t>()); }
-		inline float ReadF32_B() { return Endian::Swap(Internal_ReadT<float>()); }
+		inline bool IsBigEndian() { return mEndianness == Endianness::Big; }
+		inline size_t GetOffsetPosition(size_t offset, bool useBaseOffset)
+		{
+			return useBaseOffset && BaseOffsets.size() > 0 ? offset + BaseOffsets.back() : offset;
+		}
+		void Reset();
 
 		// Basic types only
 		template <typename T>
 		inline T Internal_ReadT()
 		{
-			T value;
-			Read(&value, sizeof(T));
+			T value = { };
+			if (mPosition + sizeof(T) <= mSize)
+			{
+				memcpy(&value, &mData[mPosition], sizeof(T));
+				mPosition += sizeof(T);
+			}
+
 			return value;
 		}
 	};
@@ -188,12 +486,32 @@ namespace IO
 			mCapacity = mBufferSize;
 			mEndianness = Endianness::Little;
 		}
-		~MemoryWriter() = default;
+		~MemoryWriter()
+		{
+			CloseStream();
+			ClearScheduledWrites();
+		}
 
 		inline void SetEndianness(Endianness endian) { mEndianness = endian; }
 		inline size_t GetPosition() { return mPosition; }
 		inline size_t GetSize() { return mSize; }
-		inline const void* GetData() { return mContent.get(); }
+		// NOTE: Copies any spliced data into the writer's own buffer first
+		inline const void* GetData() { Linearize(); return mContent.get(); }
+		inline size_t GetCapacity() { return mCapacity; }
+
+		// NOTE: Makes sure at least `size` bytes can be written without reallocating
+		bool Reserve(size_t size);
+
+		// NOTE: Streams the output to a file instead of keeping all of it in memory.
+		//       Once `windowSize` bytes are buffered they're written to disk, writes
+		//       to positions already on disk (e.g. scheduled offsets) are patched in
+		//       the file directly. GetData, CopyTo and Flush only see the buffered
+		//       data while streaming
+		bool OpenStream(std::string_view path, size_t windowSize = 1024 * 1024);
+		// NOTE: Writes the remaining data, closes the file and empties the writer.
+		//       Fails if any write to the file failed since OpenStream
+		bool CloseStream();
+		inline bool IsStreaming() { return mStream != nullptr; }
 
 		inline void Seek(size_t pos) { mPosition = pos; }
 		inline void SeekEnd(size_t pos) { mPosition = mSize - pos; }
@@ -209,12 +527,89 @@ namespace IO
 		inline void WriteChar(char value) { Write(&value, 1); }
 		inline void WriteInt8(int8_t value) { Write(&value, 1); }
 		inline void WriteUInt8(uint8_t value) { Write(&value, 1); }
-		inline void WriteInt16(int16_t value) { ShouldSwap() ? WriteI16_B(value) : Write(&value, 2); }
-		inline void WriteUInt16(uint16_t value) { ShouldSwap() ? WriteU16_B(value) : Write(&value, 2); }
-		inline void WriteInt32(int32_t value) { ShouldSwap() ? WriteI32_B(value) : Write(&value, 4); }
-		inline void WriteUInt32(uint32_t value) { ShouldSwap() ? WriteU32_B(value) : Write(&value, 4); }
-		inline void WriteFloat16(float value) { ShouldSwap() ? WriteF16_B(value) : WriteF16_L(value); }
-		inline void WriteFloat32(float value) { ShouldSwap() ? WriteF32_B(value) : Write(&value, 4); }
+
+		// NOTE: Fixed byte order writes, for formats that always use the same one
+		template <Endianness E> inline void WriteInt16(int16_t value) { Internal_WriteT(Endian::Convert<E>(value)); }
+		template <Endianness E> inline void WriteUInt16(uint16_t value) { Internal_WriteT(Endian::Convert<E>(value)); }
+		template <Endianness E> inline void WriteInt32(int32_t value) { Internal_WriteT(Endian::Convert<E>(value)); }
+		template <Endianness E> inline void WriteUInt32(uint32_t value) { Internal_WriteT(Endian::Convert<E>(value)); }
+		template <Endianness E> inline void WriteFloat32(float value) { Internal_WriteT(Endian::Convert<E>(value)); }
+		template <Endianness E> inline void WriteFloat16(float value)
+		{
+			Internal_WriteT(Endian::Convert<E>(static_cast<uint16_t>(FLOAT16::ToFloat16(value).GetBits())));
+		}
+
+		inline void WriteInt16(int16_t value) { IsBigEndian() ? WriteInt16<Endianness::Big>(value) : WriteInt16<Endianness::Little>(value); }
+		inline void WriteUInt16(uint16_t value) { IsBigEndian() ? WriteUInt16<Endianness::Big>(value) : WriteUInt16<Endianness::Little>(value); }
+		inline void WriteInt32(int32_t value) { IsBigEndian() ? WriteInt32<Endianness::Big>(value) : WriteInt32<Endianness::Little>(value); }
+		inline void WriteUInt32(uint32_t value) { IsBigEndian() ? WriteUInt32<Endianness::Big>(value) : WriteUInt32<Endianness::Little>(value); }
+		inline void WriteFloat16(float value) { IsBigEndian() ? WriteFloat16<Endianness::Big>(value) : WriteFloat16<Endianness::Little>(value); }
+		inline void WriteFloat32(float value) { IsBigEndian() ? WriteFloat32<Endianness::Big>(value) : WriteFloat32<Endianness::Little>(value); }
+
+		// NOTE: Writes `count` elements at once. The source array is left untouched
+		template <Endianness E, typename T>
+		inline bool WriteArray(const T* buffer, size_t count)
+		{
+			if (count > SIZE_MAX / sizeof(T))
+				return false;
+
+			if constexpr (E == Endian::Native || sizeof(T) == 1)
+				return count < 1 || Write(buffer, count * sizeof(T));
+			else
+			{
+				// NOTE: Swap through a small stack buffer
+				constexpr size_t chunkCount = 0x1000 / sizeof(T);
+				T chunk[chunkCount];
+
+				for (size_t i = 0; i < count; i += chunkCount)
+				{
+					size_t n = count - i < chunkCount ? count - i : chunkCount;
+					memcpy(chunk, &buffer[i], n * sizeof(T));
+					Endian::SwapArray(chunk, n);
+					if (!Write(chunk, n * sizeof(T)))
+						return false;
+				}
+
+				return true;
+			}
+		}
+
+		template <typename T>
+		inline bool WriteArray(const T* buffer, size_t count)
+		{
+			return IsBigEndian() ? WriteArray<Endianness::Big>(buffer, count) : WriteArray<Endianness::Little>(buffer, count);
+		}
+
+		// NOTE: Converts `count` floats to halves in batches and writes them
+		template <Endianness E>
+		inline bool WriteFloat16Array(const float* values, size_t count)
+		{
+			constexpr size_t chunkCount = 0x800;
+			uint16_t chunk[chunkCount];
+
+			for (size_t i = 0; i < count; i += chunkCount)
+			{
+				size_t n = count - i < chunkCount ? count - i : chunkCount;
+				FLOAT16::ToFloat16Array(&values[i], chunk, n);
+				if (!WriteArray<E>(chunk, n))
+					return false;
+			}
+
+			return true;
+		}
+
+		inline bool WriteFloat16Array(const float* values, size_t count)
+		{
+			return IsBigEndian() ? WriteFloat16Array<Endianness::Big>(values, count) : WriteFloat16Array<Endianness::Little>(values, count);
+		}
+
+		// NOTE: Appends the data at the end of the stream without copying it. The
+		//       data must stay alive and unchanged for as long as this writer uses it
+		void Splice(const void* data, size_t size);
+		// NOTE: Takes over the contents of another writer without copying them.
+		//       Its scheduled writes have to be flushed beforehand
+		void Splice(MemoryWriter&& other);
+
 		inline void WriteString(std::string_view value)
 		{
 			for (const char& c : value)
@@ -228,66 +623,139 @@ namespace IO
 				WriteChar(padding);
 		}
 
-		void ScheduleWrite(std::function<void(IO::MemoryWriter&)> task);
-		void ScheduleWriteOffset(std::function<void(IO::MemoryWriter&)> task, size_t baseOffset = 0);
-		void ScheduleWriteOffsetAndSize(std::function<void(IO::MemoryWriter&)> task, size_t baseOffset = 0);
+		// NOTE: Tasks are stored in an arena until they're flushed
+		template <typename Fn>
+		inline void ScheduleWrite(Fn&& task) { AddScheduledWrite(std::forward<Fn>(task)); }
+
+		template <typename Fn>
+		inline void ScheduleWriteOffset(Fn&& task, size_t baseOffset = 0)
+		{
+			ScheduledWrite& schedule = AddScheduledWrite(std::forward<Fn>(task));
+			schedule.OffsetPosition = GetPosition();
+			schedule.BaseOffset = baseOffset;
+			WriteUInt32(0);
+		}
+
+		template <typename Fn>
+		inline void ScheduleWriteOffsetAndSize(Fn&& task, size_t baseOffset = 0)
+		{
+			ScheduledWrite& schedule = AddScheduledWrite(std::forward<Fn>(task));
+			schedule.BaseOffset = baseOffset;
+			schedule.OffsetPosition = GetPosition();
+			WriteUInt32(0);
+			schedule.SizePosition = GetPosition();
+			WriteUInt32(0);
+		}
+
+		// NOTE: The string data isn't copied, it must stay alive until the strings are flushed
 		void ScheduleWriteStringOffset(const std::string_view data, size_t baseOffset = 0);
 		void FlushScheduledWrites();
-		void FlushScheduledStrings();
+		void FlushScheduledStrings(StringPooling pooling = StringPooling::None);
 
 		bool Flush(std::string_view path);
 		bool CopyTo(MemoryWriter& destination);
 	private:
+		static constexpr size_t NoPosition = SIZE_MAX;
+
 		struct ScheduledWrite
 		{
-			int32_t OffsetPosition = -1;
-			int32_t SizePosition = -1;
+			size_t OffsetPosition = NoPosition;
+			size_t SizePosition = NoPosition;
 			size_t BaseOffset = 0;
-			std::function<void(IO::MemoryWriter&)> Task;
+			// NOTE: Type-erased task living in mScheduleArena
+			void* Task = nullptr;
+			void (*Invoke)(void* task, MemoryWriter& writer) = nullptr;
+			void (*Destroy)(void* task) = nullptr;
 		};
 
 		struct ScheduledString
 		{
-			int32_t OffsetPosition = -1;
+			size_t OffsetPosition = NoPosition;
 			size_t BaseOffset = 0;
-			std::string Data;
+			std::string_view Data;
+		};
+
+		// NOTE: Data inserted into the stream without being copied to mContent,
+		//       which only holds the bytes written around the extents
+		struct Extent
+		{
+			size_t Position = 0;    // Position in the stream
+			size_t OwnPosition = 0; // Position in mContent it was inserted at
+			size_t Size = 0;
+			const uint8_t* Data = nullptr;
+			std::unique_ptr<uint8_t[]> Content; // Only set if the data is owned
 		};
 
 		std::vector<size_t> BaseOffsets;
-		std::list<ScheduledWrite> ScheduledWrites;
-		std::list<ScheduledString> ScheduledStrings;
+		std::vector<Extent> mExtents;
+		size_t mExtentSize = 0;
+		// NOTE: Everything before mBase was already written to mStream
+		FILE* mStream = nullptr;
+		// NOTE: Sticky, so writes whose result isn't checked (e.g. Splice)
+		//       still make CloseStream fail
+		bool mStreamFailed = false;
+		size_t mBase = 0;
+		size_t mWindowSize = 0;
+		std::vector<ScheduledWrite> ScheduledWrites;
+		std::vector<ScheduledString> ScheduledStrings;
+		Arena mScheduleArena;
 		std::unique_ptr<uint8_t[]> mContent;
 		size_t mSize, mPosition, mCapacity;
 		Endianness mEndianness;
 		const size_t mBufferSize = 256 * 1024; // 256kb
 
 
-		inline bool ShouldSwap() { return mEndianness == Endianness::Big; }
+		inline bool IsBigEndian() { return mEndianness == Endianness::Big; }
 
-		// Internal use only
-		inline bool WriteI16_B(int16_t value) { int16_t v = Endian::Swap(value); Write(&v, 2); return true; }
-		inline bool WriteU16_B(uint16_t value) { uint16_t v = Endian::Swap(value); Write(&v, 2); return true; }
-		inline bool WriteI32_B(int32_t value) { int32_t v = Endian::Swap(value); Write(&v, 4); return true; }
-		inline bool WriteU32_B(uint32_t value) { uint32_t v = Endian::Swap(value); Write(&v, 4); return true; }
-		inline bool WriteF16_L(float value) { FLOAT16 v = FLOAT16::ToFloat16(value); Write(&v, 2); return true; }
-		inline bool WriteF16_B(float value)
+		template <typename Fn>
+		inline ScheduledWrite& AddScheduledWrite(Fn&& task)
 		{
-			FLOAT16 v = FLOAT16::ToFloat16(value);
-			uint16_t swapValue = Endian::Swap(*(uint16_t*)&v);
-			Write(&swapValue, 2);
-			return true;
+			using Task = std::decay_t<Fn>;
+
+			void* storage = mScheduleArena.Allocate(sizeof(Task), alignof(Task));
+			ScheduledWrite& schedule = ScheduledWrites.emplace_back();
+			schedule.Task = new (storage) Task(std::forward<Fn>(task));
+			schedule.Invoke = [](void* task, MemoryWriter& writer) { (*static_cast<Task*>(task))(writer); };
+			if constexpr (!std::is_trivially_destructible_v<Task>)
+				schedule.Destroy = [](void* task) { static_cast<Task*>(task)->~Task(); };
+
+			return schedule;
 		}
-		inline bool WriteF32_B(float value) { float v = Endian::Swap(value); Write(&v, 4); return true; }
 
-		inline void ExpandBuffer()
+		void ClearScheduledWrites();
+		inline size_t GetOwnSize() { return mSize - mBase - mExtentSize; }
+
+		bool WriteInExtents(const void* buffer, size_t size);
+		bool WriteStreamed(size_t position, const void* buffer, size_t size);
+		void Linearize();
+		bool Spill();
+
+		// NOTE: Calls visit(data, size) for every contiguous piece of the stream, in order
+		template <typename Fn>
+		inline void VisitSegments(Fn visit)
 		{
-			auto cont = std::make_unique<uint8_t[]>(mCapacity + mBufferSize);
-			if (cont == nullptr)
-				return;
+			size_t own = 0;
+			for (const Extent& ext : mExtents)
+			{
+				if (ext.OwnPosition > own)
+					visit(&mContent[own], ext.OwnPosition - own);
+				visit(ext.Data, ext.Size);
+				own = ext.OwnPosition;
+			}
+
+			if (GetOwnSize() > own)
+				visit(&mContent[own], GetOwnSize() - own);
+		}
 
-			memcpy(cont.get(), mContent.get(), mSize);
-			mContent = std::move(cont);
-			mCapacity += mBufferSize;
+		// Basic types only
+		template <typename T>
+		inline void Internal_WriteT(T value) { Write(&value, sizeof(T)); }
+
+		// NOTE: Grow geometrically so writing N bytes only copies O(N) bytes in total
+		inline void ExpandBuffer(size_t required)
+		{
+			size_t capacity = mCapacity + mCapacity / 2;
+			Reserve(capacity > required ? capacity : required);
 		}
 	};
 
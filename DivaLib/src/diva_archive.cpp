@@ -3,11 +3,17 @@
 
 using namespace Archive;
 
+// NOTE: FArc headers are always big endian
+constexpr IO::Endianness FArcEndianness = IO::Endianness::Big;
+
 bool Archive::FArc::Open(std::string_view path)
 {
 	mStream.FromFile(path);
-	mStream.SetEndianness(IO::Endianness::Big);
-	ReadHeader();
+	if (!ReadHeader())
+	{
+		Close();
+		return false;
+	}
 
 	return true;
 }
@@ -23,11 +29,11 @@ Archive::FArc::FileData Archive::FArc::GetFile(std::string_view name)
 
 	for (const FileEntry& entry : mFiles)
 	{
-		if (strcmp(name.data(), entry.Name.data()) != 0)
+		if (name != entry.Name)
 			continue;
 
-		file.Size = entry.Size;
-		file.Data = new uint8_t[entry.Size];
+		file.Size = static_cast<size_t>(entry.Size);
+		file.Data = new uint8_t[file.Size];
 
 		// Try reading the data from the archive
 		mStream.SeekBegin(entry.Offset);
@@ -42,11 +48,38 @@ Archive::FArc::FileData Archive::FArc::GetFile(std::string_view name)
 	return file;
 }
 
-void Archive::FArc::ReadHeader()
+bool Archive::FArc::OpenFile(std::string_view name, IO::Reader& reader)
 {
-	int32_t signature = mStream.ReadInt32();
-	int32_t headerSize = mStream.ReadInt32();
-	int32_t alignment = mStream.ReadInt32();
+	const FileEntry* entry = FindEntry(name);
+	if (entry == nullptr || mIsCompressed)
+		return false;
+
+	if (!reader.FromReader(mStream, static_cast<size_t>(entry->Offset), static_cast<size_t>(entry->Size)))
+		return false;
+
+	// NOTE: Only the archive header is big endian
+	reader.SetEndianness(IO::Endianness::Little);
+	return true;
+}
+
+const Archive::FArc::FileEntry* Archive::FArc::FindEntry(std::string_view name) const
+{
+	for (const FileEntry& entry : mFiles)
+		if (name == entry.Name)
+			return &entry;
+
+	return nullptr;
+}
+
+bool Archive::FArc::ReadHeader()
+{
+	// NOTE: Signature, header size and alignment
+	if (!mStream.CheckRange(0, 0x0C))
+		return false;
+
+	int32_t signature = mStream.ReadUnchecked<FArcEndianness, int32_t>();
+	int32_t headerSize = mStream.ReadUnchecked<FArcEndianness, int32_t>();
+	int32_t alignment = mStream.ReadUnchecked<FArcEndianness, int32_t>();
 
 	switch (signature)
 	{
@@ -62,20 +95,41 @@ void Archive::FArc::ReadHeader()
 		mIsCompressed = true;
 		mIsEncrypted  = true;
 		break;
+	default:
+		return false;
 	}
 
+	// NOTE: The whole header is validated once, entries only need
+	//       their fields checked since names are variable length
+	const size_t headerEnd = static_cast<size_t>(headerSize) + 0x08;
+	if (headerSize < 0 || !mStream.CheckRange(0, headerEnd))
+		return false;
+
+	const size_t fieldsSize = mIsCompressed ? 0x0C : 0x08;
+
 	// Read file entries
-	while (mStream.GetPosition() < (size_t)(headerSize + 8))
+	while (mStream.GetPosition() < headerEnd)
 	{
 		FileEntry entry = { };
 		entry.Name = mStream.ReadString(); // File name
-		entry.Offset = mStream.ReadInt32();
+		if (!mStream.CheckRange(mStream.GetPosition(), fieldsSize))
+			return false;
+
+		// NOTE: Offsets and sizes are unsigned, so archives can go up to 4 GB
+		entry.Offset = mStream.ReadUnchecked<FArcEndianness, uint32_t>();
 		if (mIsCompressed)
-			entry.CompressedSize = mStream.ReadInt32();
-		entry.Size = mStream.ReadInt32();
+			entry.CompressedSize = mStream.ReadUnchecked<FArcEndianness, uint32_t>();
+		entry.Size = mStream.ReadUnchecked<FArcEndianness, uint32_t>();
+
+		// NOTE: Make sure the data is actually inside the archive
+		const uint64_t storedSize = mIsCompressed ? entry.CompressedSize : entry.Size;
+		if (!mStream.CheckRange(static_cast<size_t>(entry.Offset), static_cast<size_t>(storedSize)))
+			return false;
 
 		mFiles.push_back(entry);
 	}
+
+	return true;
 }
 
 constexpr size_t FArcAlignment = 0x10;
@@ -94,22 +148,36 @@ bool FArcPacker::Flush(std::string_view path, bool compress)
 	if (path.empty())
 		return false;
 	
+	size_t headerSize = GetHeaderSize(compress);
+	uint64_t fileOffset = IO::Util::Align(headerSize + 0x08, FArcAlignment);
+
+	// NOTE: Offsets and sizes are stored as 32-bit, check everything fits before writing
+	uint64_t archiveSize = fileOffset;
+	for (const FArcFile& file : mFiles)
+		archiveSize = IO::Util::Align(archiveSize + file.Size, FArcAlignment);
+
+	if (archiveSize > UINT32_MAX)
+		return false;
+
+	// NOTE: Stream the archive to disk so it never has to fit in memory
 	IO::Writer writer;
-	writer.SetEndianness(IO::Endianness::Big);
+	if (!writer.OpenStream(path))
+		return false;
 
-	size_t headerSize = GetHeaderSize(compress);
-	int32_t fileOffset = IO::Util::Align(headerSize + 0x08, FArcAlignment);
+	// NOTE: File data is spliced in, so only the header and padding
+	//       have to be allocated
+	writer.Reserve(fileOffset + mFiles.size() * FArcAlignment);
 
-	writer.WriteInt32('FArc');
-	writer.WriteInt32(headerSize);
-	writer.WriteInt32(FArcAlignment);
+	writer.WriteInt32<FArcEndianness>('FArc');
+	writer.WriteInt32<FArcEndianness>(headerSize);
+	writer.WriteInt32<FArcEndianness>(FArcAlignment);
 
 	// Write header
 	for (const FArcFile& file : mFiles)
 	{
 		writer.WriteString(file.Filename);
-		writer.WriteInt32(fileOffset);
-		writer.WriteInt32(file.Size);
+		writer.WriteUInt32<FArcEndianness>(static_cast<uint32_t>(fileOffset));
+		writer.WriteUInt32<FArcEndianness>(static_cast<uint32_t>(file.Size));
 
 		fileOffset += file.Size;
 		fileOffset = IO::Util::Align(fileOffset, FArcAlignment);
@@ -121,13 +189,11 @@ bool FArcPacker::Flush(std::string_view path, bool compress)
 	// Write file data
 	for (const FArcFile& file : mFiles)
 	{
-		writer.Write(file.Data, file.Size);
+		writer.Splice(file.Data, file.Size);
 		writer.Pad(FArcAlignment, 'x');
 	}
 
-	writer.Flush(path);
-
-	return true;
+	return writer.CloseStream();
 }
 
 size_t FArcPacker::GetHeaderSize(bool compressed)
@@ -12,7 +12,7 @@ namespace Archive
 	public:
 		struct FileData
 		{
-			int32_t Size;
+			size_t Size;
 			void* Data;
 
 			inline bool Valid() { return Data != nullptr; }
@@ -29,13 +29,17 @@ namespace Archive
 		bool Open(std::string_view path);
 		void Close();
 		FileData GetFile(std::string_view name);
+		// NOTE: Points the reader directly at the file data inside the archive
+		//       without copying it. Only works for uncompressed archives and
+		//       the reader is only valid while the archive is open
+		bool OpenFile(std::string_view name, IO::Reader& reader);
 	private:
 		struct FileEntry
 		{
 			std::string Name;
-			int32_t Offset;
-			int32_t Size;
-			int32_t CompressedSize;
+			uint64_t Offset;
+			uint64_t Size;
+			uint64_t CompressedSize;
 		};
 
 		std::vector<FileEntry> mFiles;
@@ -45,7 +49,8 @@ namespace Archive
 		bool mIsCompressed; // FArC, FARC
 		bool mIsEncrypted;  // FARC
 
-		void ReadHeader();
+		bool ReadHeader();
+		const FileEntry* FindEntry(std::string_view name) const;
 	};
 
 	class FArcPacker
@@ -21,168 +21,232 @@ namespace Aet
 				}
 	}
 
-	static void ReadProperty1D(IO::Reader& reader, Aet::Property1D& prop)
+	// NOTE: Sizes of the on-disk structures, used to validate each table
+	//       once before reading its entries unchecked
+	constexpr size_t SceneSize = 0x38;
+	constexpr size_t CompositionSize = 0x08;
+	constexpr size_t LayerSize = 0x30;
+	constexpr size_t LayerVideoSize = 0x44;
+	constexpr size_t VideoSize = 0x14;
+	constexpr size_t VideoSrcSize = 0x08;
+
+	static bool ReadProperty1D(IO::Reader& reader, Aet::Property1D& prop)
 	{
-		int32_t keyCount = reader.ReadInt32();
-		uint32_t keyOffset = reader.ReadUInt32();
+		int32_t keyCount = reader.ReadUnchecked<int32_t>();
+		uint32_t keyOffset = reader.ReadUnchecked<uint32_t>();
 
 		if (keyCount < 1 || keyOffset == 0)
-			return;
+			return true;
 
-		reader.ReadAtOffset(keyOffset, [&keyCount, &prop](IO::Reader& reader)
+		bool valid = true;
+		reader.ReadAtOffset(keyOffset, [&keyCount, &keyOffset, &prop, &valid](IO::Reader& reader)
 		{
 			if (keyCount == 1)
 				prop.Keyframes.emplace_back(0.0f, reader.ReadFloat32(), 0.0f);
 			else
 			{
-				for (int i = 0; i < keyCount; i++)
-					prop.Keyframes.emplace_back(reader.ReadFloat32(), 0.0f, 0.0f);
+				// NOTE: Checked before allocating, a corrupt count would
+				//       otherwise reserve gigabytes for a table that isn't there
+				const size_t valueCount = static_cast<size_t>(keyCount) * 3;
+				if (!reader.CheckTable(keyOffset, valueCount, sizeof(float)))
+				{
+					valid = false;
+					return;
+				}
 
-				for (Aet::Keyframe1D& key : prop.Keyframes)
+				// NOTE: All frames come first, followed by value and tangent pairs
+				std::vector<float> data(valueCount);
+				if (!reader.ReadArray(data.data(), data.size()))
 				{
-					key.Value = reader.ReadFloat32();
-					key.Tangent = reader.ReadFloat32();
+					valid = false;
+					return;
 				}
+
+				prop.Keyframes.reserve(keyCount);
+				for (int i = 0; i < keyCount; i++)
+					prop.Keyframes.emplace_back(data[i], data[keyCount + i * 2], data[keyCount + i * 2 + 1]);
 			}
 		});
+
+		return valid;
 	}
 
-	static void ReadLayerVideo(IO::Reader& reader, Aet::LayerVideo& video)
+	static bool ReadLayerVideo(IO::Reader& reader, Aet::LayerVideo& video)
 	{
-		video.TransferMode.BlendMode = (Aet::BlendMode)reader.ReadUInt8();
-		video.TransferMode.TrackMatte = (Aet::TrackMatteMode)reader.ReadUInt8();
+		video.TransferMode.BlendMode = (Aet::BlendMode)reader.ReadUnchecked<uint8_t>();
+		video.TransferMode.TrackMatte = (Aet::TrackMatteMode)reader.ReadUnchecked<uint8_t>();
 		reader.Read(&video.TransferMode.Flags, sizeof(uint8_t));
 		reader.SeekCurrent(1);
-		ReadProperty1D(reader, video.AnchorX);
-		ReadProperty1D(reader, video.AnchorY);
-		ReadProperty1D(reader, video.PositionX);
-		ReadProperty1D(reader, video.PositionY);
-		ReadProperty1D(reader, video.Rotation);
-		ReadProperty1D(reader, video.ScaleX);
-		ReadProperty1D(reader, video.ScaleY);
-		ReadProperty1D(reader, video.Opacity);
+		return ReadProperty1D(reader, video.AnchorX) &&
+			ReadProperty1D(reader, video.AnchorY) &&
+			ReadProperty1D(reader, video.PositionX) &&
+			ReadProperty1D(reader, video.PositionY) &&
+			ReadProperty1D(reader, video.Rotation) &&
+			ReadProperty1D(reader, video.ScaleX) &&
+			ReadProperty1D(reader, video.ScaleY) &&
+			ReadProperty1D(reader, video.Opacity);
 	}
 
-	static void ReadLayer(IO::Reader& reader, Aet::Layer& layer)
+	static bool ReadLayer(IO::Reader& reader, Aet::Layer& layer)
 	{
 		layer.Name = reader.ReadStringOffset();
-		layer.StartTime = reader.ReadFloat32();
-		layer.EndTime = reader.ReadFloat32();
-		layer.OffsetTime = reader.ReadFloat32();
-		layer.TimeScale = reader.ReadFloat32();
+		layer.StartTime = reader.ReadUnchecked<float>();
+		layer.EndTime = reader.ReadUnchecked<float>();
+		layer.OffsetTime = reader.ReadUnchecked<float>();
+		layer.TimeScale = reader.ReadUnchecked<float>();
 		reader.Read(&layer.Flags, sizeof(uint16_t));
-		layer.Quality = (Aet::Quality)reader.ReadUInt8();
-		layer.ItemType = (Aet::ItemType)reader.ReadUInt8();
-		layer.Item = (void*)reader.ReadUInt32();
-		reader.ReadUInt32(); // Parent offset
+		layer.Quality = (Aet::Quality)reader.ReadUnchecked<uint8_t>();
+		layer.ItemType = (Aet::ItemType)reader.ReadUnchecked<uint8_t>();
+		layer.Item = (void*)reader.ReadUnchecked<uint32_t>();
+		reader.ReadUnchecked<uint32_t>(); // Parent offset
+
+		int32_t markerCount = reader.ReadUnchecked<int32_t>();
+		uint32_t markerOffset = reader.ReadUnchecked<uint32_t>();
+		uint32_t videoOffset = reader.ReadUnchecked<uint32_t>();
+		uint32_t audioOffset = reader.ReadUnchecked<uint32_t>();
+
+		if (videoOffset == 0)
+			return true;
 
-		int32_t markerCount = reader.ReadInt32();
-		uint32_t markerOffset = reader.ReadUInt32();
-		uint32_t videoOffset = reader.ReadUInt32();
-		uint32_t audioOffset = reader.ReadUInt32();
+		if (!reader.CheckRange(videoOffset, LayerVideoSize))
+			return false;
 
-		reader.ReadAtOffset(videoOffset, [&](IO::Reader& reader) { ReadLayerVideo(reader, layer.Video); });
+		bool valid = true;
+		reader.ReadAtOffset(videoOffset, [&](IO::Reader& reader) { valid = ReadLayerVideo(reader, layer.Video); });
+		return valid;
 	}
 
-	static void ReadComposition(IO::Reader& reader, Aet::Composition& comp)
+	static bool ReadComposition(IO::Reader& reader, Aet::Composition& comp)
 	{
-		int32_t layerCount = reader.ReadInt32();
-		uint32_t layerOffset = reader.ReadUInt32();
+		int32_t layerCount = reader.ReadUnchecked<int32_t>();
+		uint32_t layerOffset = reader.ReadUnchecked<uint32_t>();
 
+		if (layerCount < 0 || !reader.CheckTable(layerOffset, layerCount, LayerSize))
+			return false;
+
+		bool valid = true;
 		reader.ReadAtOffset(layerOffset, [&](IO::Reader& reader)
 		{
-			for (int i = 0; i < layerCount; i++)
+			comp.Layers.reserve(layerCount);
+			for (int i = 0; i < layerCount && valid; i++)
 			{
 				Aet::Layer& layer = comp.Layers.emplace_back();
-				Aet::ReadLayer(reader, layer);
+				valid = Aet::ReadLayer(reader, layer);
 			}
 		});
+
+		return valid;
 	}
 
-	static void ReadVideo(IO::Reader& reader, Aet::Video& video)
+	static bool ReadVideo(IO::Reader& reader, Aet::Video& video)
 	{
 		reader.Read(&video.Color, 0x04);
-		video.Width = reader.ReadUInt16();
-		video.Height = reader.ReadUInt16();
-		video.Frames = reader.ReadFloat32();
+		video.Width = reader.ReadUnchecked<uint16_t>();
+		video.Height = reader.ReadUnchecked<uint16_t>();
+		video.Frames = reader.ReadUnchecked<float>();
 
-		int32_t srcCount = reader.ReadInt32();
-		uint32_t srcOffset = reader.ReadUInt32();
+		int32_t srcCount = reader.ReadUnchecked<int32_t>();
+		uint32_t srcOffset = reader.ReadUnchecked<uint32_t>();
+
+		if (srcCount < 0 || !reader.CheckTable(srcOffset, srcCount, VideoSrcSize))
+			return false;
 
 		// Read video sources
 		reader.ReadAtOffset(srcOffset, [&](IO::Reader& reader)
 		{
+			video.Sources.reserve(srcCount);
 			for (int i = 0; i < srcCount; i++)
 			{
 				// Create video source
 				Aet::VideoSrc& src = video.Sources.emplace_back();
 				// Read data from reader
 				src.Name = reader.ReadStringOffset();
-				src.Id = reader.ReadUInt32();
+				src.Id = reader.ReadUnchecked<uint32_t>();
 			}
 		});
+
+		return true;
 	}
 
-	static void ReadScene(IO::Reader& reader, Aet::Scene& scene)
+	static bool ReadScene(IO::Reader& reader, Aet::Scene& scene)
 	{
 		scene.Name = reader.ReadStringOffset();
-		scene.StartFrame = reader.ReadFloat32();
-		scene.EndFrame = reader.ReadFloat32();
-		scene.Framerate = reader.ReadFloat32();
+		scene.StartFrame = reader.ReadUnchecked<float>();
+		scene.EndFrame = reader.ReadUnchecked<float>();
+		scene.Framerate = reader.ReadUnchecked<float>();
 		reader.Read(scene.BackgroundColor, 4);
-		scene.Width = reader.ReadInt32();
-		scene.Height = reader.ReadInt32();
-
-		uint32_t cameraOffset = reader.ReadUInt32();
-		int32_t compCount = reader.ReadInt32();
-		uint32_t compOffset = reader.ReadUInt32();
-		int32_t videoCount = reader.ReadInt32();
-		uint32_t videoOffset = reader.ReadUInt32();
-		int32_t audioCount = reader.ReadInt32();
-		uint32_t audioOffset = reader.ReadUInt32();
+		scene.Width = reader.ReadUnchecked<int32_t>();
+		scene.Height = reader.ReadUnchecked<int32_t>();
+
+		uint32_t cameraOffset = reader.ReadUnchecked<uint32_t>();
+		int32_t compCount = reader.ReadUnchecked<int32_t>();
+		uint32_t compOffset = reader.ReadUnchecked<uint32_t>();
+		int32_t videoCount = reader.ReadUnchecked<int32_t>();
+		uint32_t videoOffset = reader.ReadUnchecked<uint32_t>();
+		int32_t audioCount = reader.ReadUnchecked<int32_t>();
+		uint32_t audioOffset = reader.ReadUnchecked<uint32_t>();
+
+		// NOTE: Validate both tables in one go, their entries are read unchecked
+		if (compCount < 0 || videoCount < 0 ||
+			!reader.CheckTable(compOffset, compCount, CompositionSize) ||
+			!reader.CheckTable(videoOffset, videoCount, VideoSize))
+			return false;
+
+		// NOTE: Items are referenced by pointer, so these can't reallocate
+		scene.Compositions.reserve(compCount);
+		scene.Videos.reserve(videoCount);
 
 		std::vector<Aet::ItemReference> itemReferences;
+		itemReferences.reserve(static_cast<size_t>(compCount) + videoCount);
+		bool valid = true;
 
 		reader.ReadAtOffset(compOffset, [&](IO::Reader& reader)
 		{
-			for (int i = 0; i < compCount; i++)
+			for (int i = 0; i < compCount && valid; i++)
 			{
 				// Create new composition
 				Aet::Composition& comp = scene.Compositions.emplace_back();
 				// Store reference
 				itemReferences.push_back(std::make_pair<uint64_t, void*>(reader.GetPosition(), &comp));
 				// Read data from reader
-				Aet::ReadComposition(reader, comp);
+				valid = Aet::ReadComposition(reader, comp);
 			}
 		});
 
 		reader.ReadAtOffset(videoOffset, [&](IO::Reader& reader)
 		{
-			for (int i = 0; i < videoCount; i++)
+			for (int i = 0; i < videoCount && valid; i++)
 			{
 				// Create new video
 				Aet::Video& video = scene.Videos.emplace_back();
 				// Store reference
 				itemReferences.push_back(std::make_pair<uint64_t, void*>(reader.GetPosition(), &video));
 				// Read data from reader
-				Aet::ReadVideo(reader, video);
+				valid = Aet::ReadVideo(reader, video);
 			}
 		});
 
 		// Resolve item references
 		Aet::FixItemReferences(scene, itemReferences);
+		return valid;
 	}
 }
 
-void Aet::AetSet::Parse(IO::Reader& reader)
+bool Aet::AetSet::Parse(IO::Reader& reader)
 {
+	bool valid = true;
 	uint32_t offset = 0;
-	while (offset = reader.ReadInt32(), offset != 0)
+	while (valid && (offset = reader.ReadInt32(), offset != 0))
 	{
-		reader.ReadAtOffset(offset, [this](IO::Reader& reader)
+		if (!reader.CheckRange(offset, Aet::SceneSize))
+			return false;
+
+		reader.ReadAtOffset(offset, [this, &valid](IO::Reader& reader)
 		{
 			Aet::Scene& scene = Scenes.emplace_back();
-			Aet::ReadScene(reader, scene);
+			valid = Aet::ReadScene(reader, scene);
 		});
 	}
-}
\ No newline at end of file
+
+	return valid;
+}
@@ -121,7 +121,7 @@ namespace Aet
 
 		struct TransferMode
 		{
-			BlendMode BlendMode;
+			Aet::BlendMode BlendMode;
 			TrackMatteMode TrackMatte;
 			TransferModeFlags Flags;
 			uint8_t Reserved;
@@ -147,8 +147,8 @@ namespace Aet
 		float OffsetTime;
 		float TimeScale;
 		LayerFlags Flags;
-		Quality Quality;
-		ItemType ItemType;
+		Aet::Quality Quality;
+		Aet::ItemType ItemType;
 		void* Item;
 		LayerVideo Video;
 		LayerAudio Audio;
@@ -191,6 +191,6 @@ namespace Aet
 	public:
 		std::vector<Scene> Scenes;
 
-		void Parse(IO::Reader& reader);
+		bool Parse(IO::Reader& reader);
 	};
 }
\ No newline at end of file
@@ -38,27 +38,33 @@ namespace Auth
 		{
 			const auto& key = data.Keys[i];
 
-			sprintf_s(buffer, bufferSize, "key.%d", i);
+			snprintf(buffer, bufferSize, "key.%d", i);
 			// key.%d
 			prop.OpenScope(buffer);
 			{
 				prop.Add("type", key.Type);
+
+				// NOTE: Each key type adds one more value to the tuple
+				const float values[] = { key.Frame, key.Value, key.T1, key.T2 };
+				size_t valueCount = 0;
 				switch (key.Type)
 				{
 				case KEY_TYPE_NONE:
-					sprintf_s(buffer, bufferSize, "(%f)", key.Frame);
+					valueCount = 1;
 					break;
 				case KEY_TYPE_STATIC:
-					sprintf_s(buffer, bufferSize, "(%f,%f)", key.Frame, key.Value);
+					valueCount = 2;
 					break;
 				case KEY_TYPE_LINEAR:
-					sprintf_s(buffer, bufferSize, "(%f,%f,%f)", key.Frame, key.Value, key.T1);
+					valueCount = 3;
 					break;
 				case KEY_TYPE_HERMITE:
-					sprintf_s(buffer, bufferSize, "(%f,%f,%f,%f)", key.Frame, key.Value, key.T1, key.T2);
+					valueCount = 4;
 					break;
 				}
-				prop.Add("data", buffer);
+
+				if (valueCount > 0)
+					prop.AddTuple("data", values, valueCount);
 			}
 			prop.CloseScope();
 		}
@@ -130,7 +136,7 @@ namespace Auth
 		prop.Add("node.length", static_cast<int32_t>(hrc.Nodes.size()));
 		for (size_t i = 0; i < hrc.Nodes.size(); i++)
 		{
-			sprintf_s(buffer, 0x40, "node.%d", static_cast<int32_t>(i));
+			snprintf(buffer, 0x40, "node.%d", static_cast<int32_t>(i));
 			prop.OpenScope(buffer);
 			WriteHrcNode(prop, hrc.Nodes[i]);
 			prop.CloseScope();
@@ -154,12 +160,12 @@ namespace Auth
 			return;
 
 		char buffer[0x40] = { '\0' };
-		sprintf_s(buffer, 0x40, "%s.length", name.data());
+		snprintf(buffer, 0x40, "%s.length", name.data());
 
 		prop.Add(buffer, data.size());
 		for (size_t i = 0; i < data.size(); i++)
 		{
-			sprintf_s(buffer, 0x40, "%s.%zu", name.data(), i);
+			snprintf(buffer, 0x40, "%s.%zu", name.data(), i);
 			prop.Add(buffer, data[i]);
 		}
 	}
@@ -191,7 +197,7 @@ bool Auth3D::Write(IO::Writer& writer)
 		prop.Add("camera_root.length", static_cast<int32_t>(Cameras.size()));
 		for (size_t i = 0; i < Cameras.size(); i++)
 		{
-			sprintf_s(buffer, bufferSize, "camera_root.%d", static_cast<int32_t>(i));
+			snprintf(buffer, bufferSize, "camera_root.%d", static_cast<int32_t>(i));
 			prop.OpenScope(buffer);
 			Auth::WriteCameraRoot(prop, Cameras[i]);
 			prop.CloseScope();
@@ -203,7 +209,7 @@ bool Auth3D::Write(IO::Writer& writer)
 		prop.Add("objhrc.length", static_cast<int32_t>(ObjectHrcs.size()));
 		for (size_t i = 0; i < ObjectHrcs.size(); i++)
 		{
-			sprintf_s(buffer, bufferSize, "objhrc.%d", static_cast<int32_t>(i));
+			snprintf(buffer, bufferSize, "objhrc.%d", static_cast<int32_t>(i));
 			prop.OpenScope(buffer);
 			Auth::WriteObjectHrc(prop, ObjectHrcs[i]);
 			prop.CloseScope();
@@ -214,7 +220,7 @@ bool Auth3D::Write(IO::Writer& writer)
 	prop.Add("object_list.length", static_cast<int32_t>(ObjectList.size()));
 	for (size_t i = 0; i < Objects.size(); i++)
 	{
-		sprintf_s(buffer, bufferSize, "object.%d", static_cast<int32_t>(i));
+		snprintf(buffer, bufferSize, "object.%d", static_cast<int32_t>(i));
 		prop.OpenScope(buffer);
 		Auth::WriteObject(prop, Objects[i]);
 		prop.CloseScope();
@@ -222,7 +228,7 @@ bool Auth3D::Write(IO::Writer& writer)
 
 	for (size_t i = 0; i < ObjectList.size(); i++)
 	{
-		sprintf_s(buffer, bufferSize, "object_list.%d", static_cast<int32_t>(i));
+		snprintf(buffer, bufferSize, "object_list.%d", static_cast<int32_t>(i));
 		prop.Add(buffer, ObjectList[i]);
 	}
 
@@ -258,31 +264,61 @@ namespace AuthCompressed
 				break;
 			}
 
-			for (size_t i = 0; i < prop.Keys.size(); i++)
+			// NOTE: Uncompressed keys are written all at once
+			if (compress == Auth::CompressF16::No)
+			{
+				std::vector<float> data;
+				data.reserve(prop.Keys.size() * 4);
+				for (const auto& key : prop.Keys)
+					data.insert(data.end(), { key.Frame, key.Value, key.T1, key.T2 });
+
+				bin.WriteArray(data.data(), data.size());
+				return;
+			}
+
+			// NOTE: Half values are converted all at once, then interleaved with the frames
+			const size_t keyCount = prop.Keys.size();
+			const size_t halfsPerKey = compress == Auth::CompressF16::Compact ? 3 : 1;
+
+			std::vector<float> values;
+			values.reserve(keyCount * halfsPerKey);
+			for (const auto& key : prop.Keys)
 			{
-				auto& key = prop.Keys[i];
+				values.push_back(key.Value);
+				if (halfsPerKey == 3)
+					values.insert(values.end(), { key.T1, key.T2 });
+			}
 
-				switch (compress)
+			std::vector<uint16_t> halfs(values.size());
+			FLOAT16::ToFloat16Array(values.data(), halfs.data(), values.size());
+
+			switch (compress)
+			{
+			case Auth::CompressF16::Normal:
+				for (size_t i = 0; i < keyCount; i++)
 				{
-				case Auth::CompressF16::No:
-					bin.WriteFloat32(key.Frame);
-					bin.WriteFloat32(key.Value);
-					bin.WriteFloat32(key.T1);
-					bin.WriteFloat32(key.T2);
-					break;
-				case Auth::CompressF16::Normal:
+					auto& key = prop.Keys[i];
 					bin.WriteUInt16(static_cast<uint16_t>(key.Frame));
-					bin.WriteFloat16(key.Value);
+					bin.WriteUInt16(halfs[i]);
 					bin.WriteFloat32(key.T1);
 					bin.WriteFloat32(key.T2);
-					break;
-				case Auth::CompressF16::Compact:
-					bin.WriteUInt16(static_cast<uint16_t>(key.Frame));
-					bin.WriteFloat16(key.Value);
-					bin.WriteFloat16(key.T1);
-					bin.WriteFloat16(key.T2);
-					break;
 				}
+				break;
+			case Auth::CompressF16::Compact:
+			{
+				// NOTE: Every field is 16-bit, so the whole key list is one array
+				std::vector<uint16_t> data(keyCount * 4);
+				for (size_t i = 0; i < keyCount; i++)
+				{
+					data[i * 4] = static_cast<uint16_t>(prop.Keys[i].Frame);
+					memcpy(&data[i * 4 + 1], &halfs[i * 3], sizeof(uint16_t) * 3);
+				}
+
+				bin.WriteArray(data.data(), data.size());
+				break;
+			}
+			default:
+				break;
 			}
 		});
 	}
@@ -323,7 +359,7 @@ namespace AuthCompressed
 		for (size_t i = 0; i < hrc.Nodes.size(); i++)
 		{
 			auto& node = hrc.Nodes[i];
-			sprintf_s(buffer, 0x40, "node.%zu", i);
+			snprintf(buffer, 0x40, "node.%zu", i);
 			prop.OpenScope(buffer);
 			WriteHrcNode(prop, bin, node, compress);
 			prop.CloseScope();
@@ -346,7 +382,7 @@ bool Auth3D::WriteCompressed(IO::Writer& destination)
 	for (size_t i = 0; i < ObjectHrcs.size(); i++)
 	{
 		auto& hrc = ObjectHrcs[i];
-		sprintf_s(buffer, 0x40, "objhrc.%zu", i);
+		snprintf(buffer, 0x40, "objhrc.%zu", i);
 		prop.OpenScope(buffer);
 		AuthCompressed::WriteObjectHrc(prop, binSection, hrc, CompressF16);
 		prop.CloseScope();
@@ -354,6 +390,12 @@ bool Auth3D::WriteCompressed(IO::Writer& destination)
 
 	Auth::WriteList(prop, "objhrc_list", ObjectHrcList);
 
+	// NOTE: Resolve the binary section first so the output size is known
+	//       and the destination only has to be allocated once. The binary
+	//       section itself is spliced in instead of copied
+	binSection.FlushScheduledWrites();
+	destination.Reserve(destination.GetSize() + 0x40 + IO::Util::Align(prop.GetWriteSize(), 32) + 32);
+
 	// NOTE: Flush A3DC data to destination
 	// NOTE: Write top-most header
 	const char* const signature = "#A3DC__________\n";
@@ -370,8 +412,7 @@ bool Auth3D::WriteCompressed(IO::Writer& destination)
 	destination.WriteInt32(0x424C0000);
 	destination.ScheduleWriteOffsetAndSize([&binSection](IO::Writer& writer)
 	{
-		binSection.FlushScheduledWrites();
-		binSection.CopyTo(writer);
+		writer.Splice(std::move(binSection));
 		writer.Pad(32);
 	});
 	destination.WriteInt32(0x20);
@@ -3,12 +3,25 @@
 
 using namespace Database;
 
-void SpriteDatabase::Parse(IO::Reader& reader)
+// NOTE: Sizes of the on-disk table entries
+constexpr size_t SpriteDatabaseHeaderSize = 0x10;
+constexpr size_t SpriteSetEntrySize = 0x10;
+constexpr size_t SpriteDataEntrySize = 0x0C;
+
+bool SpriteDatabase::Parse(IO::Reader& reader)
 {
-	uint32_t setCount = reader.ReadUInt32();
-	uint32_t setOffset = reader.ReadUInt32();
-	uint32_t dataCount = reader.ReadUInt32(); // Sprite and textures
-	uint32_t dataOffset = reader.ReadUInt32();
+	if (!reader.CheckRange(reader.GetPosition(), SpriteDatabaseHeaderSize))
+		return false;
+
+	uint32_t setCount = reader.ReadUnchecked<uint32_t>();
+	uint32_t setOffset = reader.ReadUnchecked<uint32_t>();
+	uint32_t dataCount = reader.ReadUnchecked<uint32_t>(); // Sprite and textures
+	uint32_t dataOffset = reader.ReadUnchecked<uint32_t>();
+
+	// NOTE: Both tables are validated once here, so their entries can be read unchecked
+	if (!reader.CheckTable(setOffset, setCount, SpriteSetEntrySize) ||
+		!reader.CheckTable(dataOffset, dataCount, SpriteDataEntrySize))
+		return false;
 
 	SpriteSets.reserve(setCount);
 
@@ -17,26 +30,33 @@ void SpriteDatabase::Parse(IO::Reader& reader)
 		for (size_t i = 0; i < setCount; i++)
 		{
 			SpriteSetInfo& info = SpriteSets.emplace_back();
-			info.Id = reader.ReadUInt32();
+			info.Id = reader.ReadUnchecked<uint32_t>();
 			info.Name = reader.ReadStringOffset();
 			info.Filename = reader.ReadStringOffset();
-			info.Index = reader.ReadInt32();
+			info.Index = reader.ReadUnchecked<int32_t>();
 		}
 	});
 
-	reader.ReadAtOffset(dataOffset, [dataCount, this](IO::Reader& reader)
+	bool valid = true;
+	reader.ReadAtOffset(dataOffset, [dataCount, &valid, this](IO::Reader& reader)
 	{
-		for (int i = 0; i < dataCount; i++)
+		for (size_t i = 0; i < dataCount; i++)
 		{
-			uint32_t id = reader.ReadUInt32();
+			uint32_t id = reader.ReadUnchecked<uint32_t>();
 			std::string name = reader.ReadStringOffset();
 			// NOTE: Bit-packed sprite data
-			int32_t setId = reader.ReadInt32();
+			int32_t setId = reader.ReadUnchecked<int32_t>();
 
 			int32_t dataIndex = setId & 0xFFFF;
 			int32_t setIndex = setId >> 0x10 & 0xFFF;
 			bool texFlag = (setId >> 0x10 & 0x1000) == 0x1000;
 
+			if (static_cast<size_t>(setIndex) >= SpriteSets.size())
+			{
+				valid = false;
+				return;
+			}
+
 			SpriteSetInfo& set = SpriteSets[setIndex];
 			SpriteDataInfo& data = texFlag ? set.Textures.emplace_back() : set.Sprites.emplace_back();
 			data.Id = id;
@@ -44,6 +64,8 @@ void SpriteDatabase::Parse(IO::Reader& reader)
 			data.DataIndex = dataIndex;
 		}
 	});
+
+	return valid;
 }
 
 void SpriteDatabase::Write(IO::Writer& writer)
@@ -95,7 +117,8 @@ void SpriteDatabase::Write(IO::Writer& writer)
 	});
 
 	writer.FlushScheduledWrites();
-	writer.FlushScheduledStrings();
+	// NOTE: Lots of sprites share names (or name endings), only write them once
+	writer.FlushScheduledStrings(IO::StringPooling::Suffixes);
 }
 
 SpriteSetInfo* SpriteDatabase::FindSpriteSetByName(std::string_view name)
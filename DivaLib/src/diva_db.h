@@ -37,7 +37,7 @@ namespace Database
 	public:
 		std::vector<SpriteSetInfo> SpriteSets;
 
-		void Parse(IO::Reader& reader);
+		bool Parse(IO::Reader& reader);
 		void Write(IO::Writer& writer);
 
 		SpriteSetInfo* FindSpriteSetByName(std::string_view name);
@@ -1,37 +1,223 @@
 #include "pch.h"
 #include <stdio.h>
 #include <algorithm>
+#include <charconv>
+#include <string.h>
 #include "diva_prop.h"
 #include "util_string.h"
 
 using namespace Property;
 
+#ifdef DIVALIB_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// NOTE: Index of the lowest set bit, mask must not be zero
+static inline uint32_t GetLowestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
 void CanonicalProperties::Parse(const char* buffer, size_t size)
 {
 	mContent = std::string(buffer, size);
+	ParseLines(mContent.data(), mContent.size());
+}
+
+void CanonicalProperties::ParseBorrowed(const char* buffer, size_t size)
+{
+	mContent.clear();
+	ParseLines(buffer, size);
+}
+
+void CanonicalProperties::ParseLines(const char* data, size_t size)
+{
+	mRanges.clear();
+
+	constexpr size_t NoSeparator = SIZE_MAX;
+	size_t lineBegin = 0;
+	size_t separator = NoSeparator;
 
-	while (mPosition < mContent.size())
+	// NOTE: Only newlines and the first '=' of each line matter, so both are
+	//       searched for at once and everything else is skipped over
+	auto visit = [&](size_t pos)
 	{
-		std::string_view line = GetNextLine();
-		int32_t sep = Util::String::GetIndex(line, '=');
-		if (line.empty() || line[0] == '#' || sep < 1)
-			continue;
+		if (data[pos] == '=')
+		{
+			if (separator == NoSeparator)
+				separator = pos;
+			return;
+		}
 
-		std::string_view key = line.substr(0, sep);
-		// NOTE: (line.size() - sep - 2) = size of line - index of '=' - 1 ('=') - 1 ('\n') 
-		std::string_view val = line.substr(sep + 1, line.size() - sep - 2);
-		mRanges.push_back(std::make_pair(key, val));
+		AddLine(data, lineBegin, separator, pos);
+		lineBegin = pos + 1;
+		separator = NoSeparator;
+	};
+
+	size_t i = 0;
+#ifdef DIVALIB_SSE2
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i equals = _mm_set1_epi8('=');
+	for (; i + 16 <= size; i += 16)
+	{
+		__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i]));
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, newline), _mm_cmpeq_epi8(chars, equals))));
+
+		for (; mask != 0; mask &= mask - 1)
+			visit(i + GetLowestBit(mask));
+	}
+#endif
+
+	for (; i < size; i++)
+		if (data[i] == '\n' || data[i] == '=')
+			visit(i);
+
+	// NOTE: Last line might not end with a newline
+	if (lineBegin < size)
+		AddLine(data, lineBegin, separator, size);
+
+	BuildIndex();
+
+	// NOTE: Handles into the old tree would point at the wrong nodes
+	mScopeNodes.clear();
+	mScopeNodeStack.assign(mScopeStepStack.size(), InvalidScope);
+}
+
+void CanonicalProperties::AddLine(const char* data, size_t begin, size_t separator, size_t end)
+{
+	if (data[begin] == '#' || separator == SIZE_MAX || separator <= begin)
+		return;
+
+	std::string_view key(&data[begin], separator - begin);
+	std::string_view val(&data[separator + 1], end - separator - 1);
+	mRanges.push_back(std::make_pair(key, val));
+}
+
+// NOTE: FNV-1a, which can be continued over several pieces of a key
+constexpr uint64_t KeyHashBasis = 0xCBF29CE484222325;
+
+static inline uint64_t HashKey(uint64_t hash, std::string_view key)
+{
+	for (char c : key)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001B3;
+	}
+
+	return hash;
+}
+
+void CanonicalProperties::BuildIndex()
+{
+	// NOTE: Keep the table at most half full so probe chains stay short
+	size_t capacity = 16;
+	while (capacity < mRanges.size() * 2)
+		capacity *= 2;
+
+	mIndex.assign(capacity, IndexSlot());
+	const size_t mask = capacity - 1;
+
+	for (size_t i = 0; i < mRanges.size(); i++)
+	{
+		const std::string_view key = mRanges[i].first;
+		const uint64_t hash = HashKey(KeyHashBasis, key);
+
+		for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+		{
+			IndexSlot& entry = mIndex[slot];
+			if (entry.Index == SIZE_MAX)
+			{
+				entry.Hash = hash;
+				entry.Index = i;
+				break;
+			}
+
+			// NOTE: First occurrence of a duplicated key wins
+			if (entry.Hash == hash && mRanges[entry.Index].first == key)
+				break;
+		}
+	}
+}
+
+template <typename Fn>
+const KeyValue* CanonicalProperties::FindInIndex(uint64_t hash, Fn&& matches) const
+{
+	if (mIndex.empty())
+		return nullptr;
+
+	const size_t mask = mIndex.size() - 1;
+	for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+	{
+		const IndexSlot& entry = mIndex[slot];
+		if (entry.Index == SIZE_MAX)
+			return nullptr;
+
+		if (entry.Hash == hash && matches(mRanges[entry.Index].first))
+			return &mRanges[entry.Index];
 	}
 }
 
 bool CanonicalProperties::OpenScope(std::string_view scope)
+{
+	const ScopeHandle parent = GetCurrentScope();
+	if (!AppendScope(scope))
+		return false;
+
+	mScopeNodeStack.push_back(FindScope(parent, scope));
+	return true;
+}
+
+bool CanonicalProperties::OpenScope(ScopeHandle scope)
+{
+	const ScopeHandle parent = GetCurrentScope();
+	if (parent == InvalidScope || scope >= mScopeNodes.size())
+		return false;
+
+	const ScopeNode& from = mScopeNodes[parent];
+	const ScopeNode& to = mScopeNodes[scope];
+	if (to.Depth <= from.Depth)
+		return false;
+
+	ScopeHandle ancestor = scope;
+	while (mScopeNodes[ancestor].Depth > from.Depth)
+		ancestor = mScopeNodes[ancestor].Parent;
+	if (ancestor != parent)
+		return false;
+
+	// NOTE: Node paths start at the root, only the part below the current scope is appended
+	if (!AppendScope(to.Path.substr(from.Depth > 0 ? from.Path.size() + 1 : 0)))
+		return false;
+
+	mScopeNodeStack.push_back(scope);
+	return true;
+}
+
+bool CanonicalProperties::AppendScope(std::string_view scope)
 {
 	if (scope.empty())
 		return false;
 
-	if (mScope[0] != '\0')
-		strcat_s(mScope, 0x80, ".");
-	strncat_s(mScope, 0x80, scope.data(), scope.size());
+	// NOTE: Scopes that don't fit (with the separator and terminator) are rejected
+	//       instead of being truncated
+	size_t length = strlen(mScope);
+	const size_t separator = length > 0 ? 1 : 0;
+	if (scope.size() + separator >= sizeof(mScope) - length)
+		return false;
+
+	if (separator > 0)
+		mScope[length++] = '.';
+	memcpy(&mScope[length], scope.data(), scope.size());
+	mScope[length + scope.size()] = '\0';
 	mScopeStepStack.push_back(Util::String::Count(scope, '.') + 1);
 	return true;
 }
@@ -53,54 +239,281 @@ bool CanonicalProperties::CloseScope()
 	}
 
 	mScopeStepStack.pop_back();
+	mScopeNodeStack.pop_back();
 	return true;
 }
 
 const KeyValue* CanonicalProperties::FindByKey(std::string_view key) const
 {
-	// NOTE: The algo will throw vector subscript error if
-	//       this is unsigned and the key does not exist
-	int32_t low = 0;
-	int32_t high = static_cast<int32_t>(mRanges.size() - 1); // Highest index
+	return FindInIndex(HashKey(KeyHashBasis, key), [key](std::string_view candidate) { return candidate == key; });
+}
 
-	if (low > high)
+const KeyValue* CanonicalProperties::FindByKeyScoped(std::string_view key) const
+{
+	if (key.size() < 1)
 		return nullptr;
 
-	char keyData[0x80] = { 0x00 };
-	while (low <= high)
+	if (mScope[0] == '\0')
+		return FindByKey(key);
+
+	// NOTE: Hash and compare "scope.key" piece by piece instead of building it
+	const std::string_view scope(mScope);
+	const uint64_t hash = HashKey(HashKey(HashKey(KeyHashBasis, scope), "."), key);
+
+	return FindInIndex(hash, [scope, key](std::string_view candidate)
 	{
-		int32_t mid = (low + high) / 2;
-		const auto& srcKey = mRanges[mid].first;
+		return candidate.size() == scope.size() + 1 + key.size() &&
+			candidate[scope.size()] == '.' &&
+			candidate.compare(0, scope.size(), scope) == 0 &&
+			candidate.compare(scope.size() + 1, key.size(), key) == 0;
+	});
+}
 
-		// HACK: This is just a placeholder fix. Should be changed later
-		strncpy_s(keyData, 0x80, srcKey.data(), srcKey.size());
-		int result = strncmp(keyData, key.data(), 0x80);
+// NOTE: Numeric segments (no leading zeros) are array indices
+static inline bool GetSegmentIndex(std::string_view segment, size_t& index)
+{
+	if (segment.empty() || segment.size() > 9 || (segment[0] == '0' && segment.size() > 1))
+		return false;
 
-		if (result == 0) return &mRanges[mid];
-		else if (result < 0) low = mid + 1;
-		else if (result > 0) high = mid - 1;
+	index = 0;
+	for (char c : segment)
+	{
+		if (c < '0' || c > '9')
+			return false;
+		index = index * 10 + static_cast<size_t>(c - '0');
 	}
 
-	return nullptr;
+	return true;
 }
 
-const KeyValue* CanonicalProperties::FindByKeyScoped(std::string_view key) const
+// NOTE: Numeric segments go first and by value, so "key.2" comes before "key.10"
+static inline int32_t CompareSegments(std::string_view left, std::string_view right)
 {
-	if (key.size() < 1)
-		return nullptr;
+	size_t leftIndex = 0, rightIndex = 0;
+	const bool leftNumeric = GetSegmentIndex(left, leftIndex);
+	const bool rightNumeric = GetSegmentIndex(right, rightIndex);
 
-	char scopeKey[0x80] = { '\0' };
-	// NOTE: Copy scope string
-	if (mScope[0] != '\0')
+	if (leftNumeric && rightNumeric)
+		return leftIndex < rightIndex ? -1 : (leftIndex > rightIndex ? 1 : 0);
+	if (leftNumeric != rightNumeric)
+		return leftNumeric ? -1 : 1;
+
+	const int result = left.compare(right);
+	return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+static inline size_t GetSegmentEnd(std::string_view key, size_t begin)
+{
+	return std::min(key.find('.', begin), key.size());
+}
+
+static bool IsKeyLess(std::string_view left, std::string_view right)
+{
+	size_t leftBegin = 0, rightBegin = 0;
+	while (true)
+	{
+		const size_t leftEnd = GetSegmentEnd(left, leftBegin);
+		const size_t rightEnd = GetSegmentEnd(right, rightBegin);
+
+		const int32_t result = CompareSegments(left.substr(leftBegin, leftEnd - leftBegin), right.substr(rightBegin, rightEnd - rightBegin));
+		if (result != 0)
+			return result < 0;
+
+		// NOTE: Parents go before their children
+		const bool leftLast = leftEnd == left.size();
+		const bool rightLast = rightEnd == right.size();
+		if (leftLast || rightLast)
+			return leftLast && !rightLast;
+
+		leftBegin = leftEnd + 1;
+		rightBegin = rightEnd + 1;
+	}
+}
+
+void CanonicalProperties::BuildScopeTree()
+{
+	std::vector<size_t> order(mRanges.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	// NOTE: Stable so the first of duplicated keys keeps the value, like the index
+	std::stable_sort(order.begin(), order.end(), [this](size_t left, size_t right)
+	{
+		return IsKeyLess(mRanges[left].first, mRanges[right].first);
+	});
+
+	// NOTE: Build the tree depth first from the sorted keys, which gives every
+	//       node its children already in order. Only the last key's path
+	//       has to be kept around to find the shared parents
+	std::vector<ScopeNode> nodes(1);
+	std::vector<size_t> path;
+	for (size_t index : order)
+	{
+		const std::string_view key = mRanges[index].first;
+		size_t depth = 0;
+		for (size_t begin = 0; ; )
+		{
+			const size_t end = GetSegmentEnd(key, begin);
+			const std::string_view name = key.substr(begin, end - begin);
+
+			if (depth < path.size() && nodes[path[depth]].Name == name)
+			{
+				depth++;
+			}
+			else
+			{
+				path.resize(depth);
+				ScopeNode& node = nodes.emplace_back();
+				node.Name = name;
+				node.Path = key.substr(0, end);
+				node.Parent = depth > 0 ? path[depth - 1] : 0;
+				node.Depth = ++depth;
+				path.push_back(nodes.size() - 1);
+			}
+
+			if (end == key.size())
+				break;
+			begin = end + 1;
+		}
+
+		path.resize(depth);
+		ScopeNode& leaf = nodes[path.back()];
+		if (leaf.Value == SIZE_MAX)
+			leaf.Value = index;
+	}
+
+	// NOTE: Group children by parent, keeping their order
+	std::vector<size_t> childBegin(nodes.size() + 1, 0);
+	for (size_t i = 1; i < nodes.size(); i++)
+		childBegin[nodes[i].Parent + 1]++;
+	for (size_t i = 1; i < childBegin.size(); i++)
+		childBegin[i] += childBegin[i - 1];
+
+	std::vector<size_t> children(nodes.size() - 1);
+	std::vector<size_t> childFill(childBegin.begin(), childBegin.end() - 1);
+	for (size_t i = 1; i < nodes.size(); i++)
+		children[childFill[nodes[i].Parent]++] = i;
+
+	// NOTE: Lay the tree out breadth first, so each node's children are contiguous
+	mScopeNodes.clear();
+	mScopeNodes.reserve(nodes.size());
+	mScopeNodes.push_back(nodes[0]);
+	std::vector<size_t> source(1, 0);
+	for (ScopeHandle handle = 0; handle < mScopeNodes.size(); handle++)
+	{
+		const size_t from = source[handle];
+		mScopeNodes[handle].FirstChild = mScopeNodes.size();
+		mScopeNodes[handle].ChildCount = childBegin[from + 1] - childBegin[from];
+
+		for (size_t i = childBegin[from]; i < childBegin[from + 1]; i++)
+		{
+			ScopeNode& child = mScopeNodes.emplace_back(nodes[children[i]]);
+			child.Parent = handle;
+			source.push_back(children[i]);
+		}
+
+		ScopeNode& node = mScopeNodes[handle];
+		size_t arrayIndex = 0;
+		while (node.ArrayCount < node.ChildCount &&
+			GetSegmentIndex(mScopeNodes[node.FirstChild + node.ArrayCount].Name, arrayIndex) &&
+			arrayIndex == node.ArrayCount)
+			node.ArrayCount++;
+	}
+
+	// NOTE: Scopes opened before the tree existed
+	const std::string_view scope(mScope);
+	size_t end = 0, next = 0;
+	for (size_t i = 0; i < mScopeStepStack.size(); i++)
 	{
-		strcpy_s(scopeKey, 0x80, mScope);
-		strcat_s(scopeKey, 0x80, ".");
+		for (int32_t step = 0; step < mScopeStepStack[i]; step++)
+		{
+			end = GetSegmentEnd(scope, next);
+			next = end + 1;
+		}
+
+		mScopeNodeStack[i] = FindScope(0, scope.substr(0, end));
 	}
-	// NOTE: Copy key string
-	strncat_s(scopeKey, 0x80, key.data(), key.size());
+}
+
+ScopeHandle CanonicalProperties::GetCurrentScope() const
+{
+	return mScopeNodeStack.empty() ? GetRootScope() : mScopeNodeStack.back();
+}
+
+ScopeHandle CanonicalProperties::FindScope(ScopeHandle parent, std::string_view path) const
+{
+	if (path.empty())
+		return parent;
+
+	// NOTE: Same split as BuildScopeTree, so "a.b." ends with an empty segment
+	for (size_t begin = 0; parent != InvalidScope; )
+	{
+		const size_t end = GetSegmentEnd(path, begin);
+		parent = FindChildScope(parent, path.substr(begin, end - begin));
+
+		if (end == path.size())
+			break;
+		begin = end + 1;
+	}
+
+	return parent;
+}
+
+ScopeHandle CanonicalProperties::FindChildScope(ScopeHandle parent, std::string_view name) const
+{
+	if (parent >= mScopeNodes.size())
+		return InvalidScope;
+
+	const ScopeNode& node = mScopeNodes[parent];
+	size_t index = 0;
+	if (GetSegmentIndex(name, index) && index < node.ArrayCount)
+		return node.FirstChild + index;
+
+	// NOTE: Children are sorted, so the rest is a binary search
+	ScopeHandle low = node.FirstChild;
+	ScopeHandle high = node.FirstChild + node.ChildCount;
+	while (low < high)
+	{
+		const ScopeHandle mid = low + (high - low) / 2;
+		const int32_t result = CompareSegments(mScopeNodes[mid].Name, name);
+
+		if (result == 0) return mid;
+		else if (result < 0) low = mid + 1;
+		else high = mid;
+	}
+
+	return InvalidScope;
+}
+
+ScopeRange CanonicalProperties::GetChildScopes(ScopeHandle scope) const
+{
+	if (scope >= mScopeNodes.size())
+		return ScopeRange();
 
-	// NOTE: Try to find full key
-	return FindByKey(scopeKey);
+	const ScopeNode& node = mScopeNodes[scope];
+	return { node.FirstChild, node.FirstChild + node.ChildCount };
+}
+
+ScopeRange CanonicalProperties::GetArrayScopes(ScopeHandle scope) const
+{
+	if (scope >= mScopeNodes.size())
+		return ScopeRange();
+
+	const ScopeNode& node = mScopeNodes[scope];
+	return { node.FirstChild, node.FirstChild + node.ArrayCount };
+}
+
+std::string_view CanonicalProperties::GetScopeName(ScopeHandle scope) const
+{
+	return scope < mScopeNodes.size() ? mScopeNodes[scope].Name : std::string_view();
+}
+
+const KeyValue* CanonicalProperties::GetScopeValue(ScopeHandle scope) const
+{
+	if (scope >= mScopeNodes.size() || mScopeNodes[scope].Value == SIZE_MAX)
+		return nullptr;
+
+	return &mRanges[mScopeNodes[scope].Value];
 }
 
 bool CanonicalProperties::Read(std::string_view key, std::string& value) const
@@ -111,53 +524,210 @@ bool CanonicalProperties::Read(std::string_view key, std::string& value) const
 	return true;
 }
 
+// NOTE: from_chars doesn't skip whitespace or accept a '+' sign like strtol/strtof did
+static inline const char* SkipNumberPrefix(const char* begin, const char* end)
+{
+	while (begin < end && (*begin == ' ' || *begin == '\t'))
+		begin++;
+	if (begin < end && *begin == '+')
+		begin++;
+	return begin;
+}
+
+static inline const char* ParseNumber(const char* begin, const char* end, int32_t& value, bool hex = false)
+{
+	begin = SkipNumberPrefix(begin, end);
+	if (!hex)
+	{
+		auto result = std::from_chars(begin, end, value);
+		return result.ec == std::errc() ? result.ptr : nullptr;
+	}
+
+	// NOTE: Hex values are bit patterns (e.g. "FFFFFFFF" is -1), so they're
+	//       read unsigned. The "0x" prefix strtol allowed is still skipped
+	if (end - begin >= 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X'))
+		begin += 2;
+
+	uint32_t bits = 0;
+	auto result = std::from_chars(begin, end, bits, 16);
+	if (result.ec != std::errc())
+		return nullptr;
+
+	value = static_cast<int32_t>(bits);
+	return result.ptr;
+}
+
+static inline const char* ParseNumber(const char* begin, const char* end, float& value)
+{
+	begin = SkipNumberPrefix(begin, end);
+	auto result = std::from_chars(begin, end, value);
+	return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+template <typename T>
+static bool ParseTupleElements(std::string_view src, T* values, size_t capacity, size_t& count)
+{
+	const char* cur = src.data();
+	const char* end = src.data() + src.size();
+
+	if (cur == end || *cur != '(')
+		return false;
+	cur++;
+
+	count = 0;
+	while (true)
+	{
+		cur = count < capacity ? ParseNumber(cur, end, values[count]) : nullptr;
+		if (cur == nullptr)
+			return false;
+		count++;
+
+		while (cur < end && (*cur == ' ' || *cur == '\t'))
+			cur++;
+		if (cur == end)
+			return false;
+
+		if (*cur == ')')
+			return true;
+		if (*cur++ != ',')
+			return false;
+	}
+}
+
 bool CanonicalProperties::Read(std::string_view key, int32_t& value, bool hex) const
 {
-	std::string src;
-	if (!Read(key, src)) return false;
-	value = strtol(src.data(), nullptr, hex ? 16 : 10);
-	return true;
+	const auto* kv = FindByKeyScoped(key);
+	if (!kv) return false;
+
+	const char* end = kv->second.data() + kv->second.size();
+	return ParseNumber(kv->second.data(), end, value, hex) != nullptr;
 }
 
 bool CanonicalProperties::Read(std::string_view key, float& value) const
 {
-	std::string src;
-	if (!Read(key, src)) return false;
-	value = strtof(src.data(), nullptr);
-	return true;
+	const auto* kv = FindByKeyScoped(key);
+	if (!kv) return false;
+
+	const char* end = kv->second.data() + kv->second.size();
+	return ParseNumber(kv->second.data(), end, value) != nullptr;
+}
+
+bool CanonicalProperties::ParseTuple(std::string_view src, int32_t* values, size_t capacity, size_t& count)
+{
+	return ParseTupleElements(src, values, capacity, count);
+}
+
+bool CanonicalProperties::ParseTuple(std::string_view src, float* values, size_t capacity, size_t& count)
+{
+	return ParseTupleElements(src, values, capacity, count);
 }
 
 void CanonicalProperties::Add(std::string_view key, std::string_view value)
 {
-	size_t keyOffset = mContent.size();
-	size_t keySize = key.size();
+	RangeMarkup mark = AppendKey(key);
+	mAddedContent += value;
+	mark.ValueSize = value.size();
+	mRangeMarkups.push_back(mark);
+}
+
+void CanonicalProperties::Add(std::string_view key, int32_t value)
+{
+	RangeMarkup mark = AppendKey(key);
+	AppendNumber(value);
+	mark.ValueSize = mAddedContent.size() - mark.ValueOffset;
+	mRangeMarkups.push_back(mark);
+}
+
+void CanonicalProperties::Add(std::string_view key, size_t value)
+{
+	RangeMarkup mark = AppendKey(key);
+	AppendNumber(value);
+	mark.ValueSize = mAddedContent.size() - mark.ValueOffset;
+	mRangeMarkups.push_back(mark);
+}
+
+void CanonicalProperties::Add(std::string_view key, float value)
+{
+	RangeMarkup mark = AppendKey(key);
+	AppendNumber(value);
+	mark.ValueSize = mAddedContent.size() - mark.ValueOffset;
+	mRangeMarkups.push_back(mark);
+}
+
+void CanonicalProperties::AddTuple(std::string_view key, const float* values, size_t count)
+{
+	RangeMarkup mark = AppendKey(key);
+	mAddedContent += '(';
+	for (size_t i = 0; i < count; i++)
+	{
+		if (i > 0)
+			mAddedContent += ',';
+		AppendNumber(values[i]);
+	}
+	mAddedContent += ')';
+
+	mark.ValueSize = mAddedContent.size() - mark.ValueOffset;
+	mRangeMarkups.push_back(mark);
+}
+
+CanonicalProperties::RangeMarkup CanonicalProperties::AppendKey(std::string_view key)
+{
+	RangeMarkup mark;
+	mark.KeyOffset = mAddedContent.size();
 	if (mScope[0] != '\0')
 	{
-		mContent += mScope;
-		mContent += '.';
-		keySize += strlen(mScope) + 1;
+		mAddedContent += mScope;
+		mAddedContent += '.';
 	}
 
-	mContent += key;
-	size_t valueOffset = mContent.size();
-	mContent += value;
+	mAddedContent += key;
+	mark.KeySize = mAddedContent.size() - mark.KeyOffset;
+	mark.ValueOffset = mAddedContent.size();
+	return mark;
+}
+
+// NOTE: Longest output of to_chars for any int32_t, size_t or float
+//       (shortest round trip, e.g. "-1.1754944e-38")
+constexpr size_t MaxNumberLength = 0x20;
+
+template <typename T>
+static inline void AppendNumberTo(std::string& content, T value)
+{
+	// NOTE: Formatted in place, the spare space is trimmed off right after
+	const size_t offset = content.size();
+	content.resize(offset + MaxNumberLength);
+
+	auto result = std::to_chars(content.data() + offset, content.data() + content.size(), value);
+	content.resize(static_cast<size_t>(result.ptr - content.data()));
+}
+
+void CanonicalProperties::AppendNumber(int32_t value)
+{
+	AppendNumberTo(mAddedContent, value);
+}
+
+void CanonicalProperties::AppendNumber(size_t value)
+{
+	AppendNumberTo(mAddedContent, value);
+}
 
-	// Create ranges
-	std::string_view keyView(mContent.data() + keyOffset, keySize);
-	std::string_view valueView(mContent.data() + valueOffset, value.size());
-	mRanges.push_back(std::make_pair(keyView, valueView));
-	mRangeMarkups.push_back({ keyOffset, keySize, valueOffset, value.size() });
-	// Rearrange all views
-	Rearrange();
+void CanonicalProperties::AppendNumber(float value)
+{
+	AppendNumberTo(mAddedContent, value);
 }
 
 void CanonicalProperties::Write(IO::Writer& writer)
 {
+	std::vector<KeyValue> ranges;
+	ranges.reserve(mRanges.size() + mRangeMarkups.size());
+	ranges.insert(ranges.end(), mRanges.begin(), mRanges.end());
+	ResolveMarkups(ranges);
+
 	// I didn't think std::sort would just work:tm:
 	// out of the box like this, but, it did! I love STL
-	std::sort(mRanges.begin(), mRanges.end());
+	std::sort(ranges.begin(), ranges.end());
 
-	for (const auto& range : mRanges)
+	for (const auto& range : ranges)
 	{
 		writer.Write(range.first.data(), range.first.size()); // Key
 		writer.WriteChar('=');
@@ -166,17 +736,24 @@ void CanonicalProperties::Write(IO::Writer& writer)
 	}
 }
 
-void CanonicalProperties::Rearrange()
+size_t CanonicalProperties::GetWriteSize() const
 {
-	if (mRanges.size() != mRangeMarkups.size())
-		return;
+	size_t size = 0;
+	for (const auto& range : mRanges)
+		size += range.first.size() + range.second.size() + 2; // '=' and '\n'
+	for (const auto& mark : mRangeMarkups)
+		size += mark.KeySize + mark.ValueSize + 2;
 
-	for (size_t i = 0; i < mRanges.size(); i++)
+	return size;
+}
+
+void CanonicalProperties::ResolveMarkups(std::vector<KeyValue>& ranges) const
+{
+	// NOTE: Views are only created here, once all entries have been added
+	for (const RangeMarkup& mark : mRangeMarkups)
 	{
-		const RangeMarkup& mark = mRangeMarkups[i];
-		auto& range = mRanges[i];
-		
-		range.first = std::string_view(mContent.data() + mark.KeyOffset, mark.KeySize);
-		range.second = std::string_view(mContent.data() + mark.ValueOffset, mark.ValueSize);
+		std::string_view key(mAddedContent.data() + mark.KeyOffset, mark.KeySize);
+		std::string_view value(mAddedContent.data() + mark.ValueOffset, mark.ValueSize);
+		ranges.push_back(std::make_pair(key, value));
 	}
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -9,6 +11,18 @@
 namespace Property
 {
 	using KeyValue = std::pair<std::string_view, std::string_view>;
+	// NOTE: Index of a node in the scope tree
+	using ScopeHandle = size_t;
+	constexpr ScopeHandle InvalidScope = SIZE_MAX;
+
+	struct ScopeRange
+	{
+		ScopeHandle Begin = 0;
+		ScopeHandle End = 0;
+
+		inline size_t GetSize() const { return End - Begin; }
+		inline bool IsEmpty() const { return Begin == End; }
+	};
 
 	class CanonicalProperties
 	{
@@ -16,9 +30,16 @@ namespace Property
 		CanonicalProperties() = default;
 		~CanonicalProperties() = default;
 
+		// NOTE: Copies the buffer, so it can be freed right after this returns
 		void Parse(const char* buffer, size_t size);
+		// NOTE: Doesn't copy the buffer. Keys and values point straight into it,
+		//       so it must stay alive and unchanged for as long as this object
+		//       is used (e.g. a FileBuffer or a reader over a mapped FArc entry)
+		void ParseBorrowed(const char* buffer, size_t size);
 
 		bool OpenScope(std::string_view scope);
+		// NOTE: Scope must be below the current one, needs the scope tree
+		bool OpenScope(ScopeHandle scope);
 		bool CloseScope();
 		const KeyValue* FindByKey(std::string_view key) const;
 		const KeyValue* FindByKeyScoped(std::string_view key) const;
@@ -26,6 +47,29 @@ namespace Property
 		bool Read(std::string_view key, int32_t& value, bool hex = false) const;
 		bool Read(std::string_view key, float& value) const;
 
+		// NOTE: Reads a parenthesised list like "(1.0,2.0,3.0)". Without count the
+		//       list has to have exactly N elements, with it anything from 1 to N
+		//       is accepted and the elements past count are left untouched
+		template <typename T, size_t N>
+		inline bool ReadTuple(std::string_view key, std::array<T, N>& values, size_t* count = nullptr) const
+		{
+			const auto* kv = FindByKeyScoped(key);
+			if (!kv) return false;
+
+			// NOTE: Parsed separately so values stay untouched on failure
+			std::array<T, N> parsed;
+			size_t read = 0;
+			if (!ParseTuple(kv->second, parsed.data(), N, read))
+				return false;
+			if (count == nullptr && read != N)
+				return false;
+
+			std::copy_n(parsed.begin(), read, values.begin());
+			if (count != nullptr)
+				*count = read;
+			return true;
+		}
+
 		template <typename T>
 		inline bool ReadEnum(std::string_view key, T& value, const char* const* rep) const
 		{
@@ -38,30 +82,39 @@ namespace Property
 			return true;
 		}
 
+		// Scope tree
+		// NOTE: Optional index over the dotted key segments of the parsed entries,
+		//       handles stay valid until the next parse. Children of a node are
+		//       stored next to each other with numeric segments first and in order,
+		//       so "key.0" to "key.N" are a single range
+		void BuildScopeTree();
+		inline bool HasScopeTree() const { return !mScopeNodes.empty(); }
+		inline ScopeHandle GetRootScope() const { return HasScopeTree() ? 0 : InvalidScope; }
+		ScopeHandle GetCurrentScope() const;
+		ScopeHandle FindScope(ScopeHandle parent, std::string_view path) const;
+		ScopeHandle FindChildScope(ScopeHandle parent, std::string_view name) const;
+		ScopeRange GetChildScopes(ScopeHandle scope) const;
+		// NOTE: Children named "0" to "N - 1", usually with a "length" sibling
+		ScopeRange GetArrayScopes(ScopeHandle scope) const;
+		std::string_view GetScopeName(ScopeHandle scope) const;
+		// NOTE: Entry whose key ends at this node, if any
+		const KeyValue* GetScopeValue(ScopeHandle scope) const;
+
 		// Writing
+		// NOTE: Added entries are only stored as offsets into their own buffer and
+		//       get resolved and sorted once, by Write. Lookups only see parsed entries
 		void Add(std::string_view key, std::string_view value);
-		inline void Add(std::string_view key, int32_t value)
-		{
-			char buffer[0x20] = { '\0' };
-			sprintf_s(buffer, 0x20, "%d", value);
-			Add(key, buffer);
-		}
-
-		inline void Add(std::string_view key, size_t value)
-		{
-			char buffer[0x20] = { '\0' };
-			sprintf_s(buffer, 0x20, "%zu", value);
-			Add(key, buffer);
-		}
-
-		inline void Add(std::string_view key, float value)
-		{
-			char buffer[0x20] = { '\0' };
-			sprintf_s(buffer, 0x20, "%g", value);
-			Add(key, buffer);
-		}
+		// NOTE: Numbers are formatted straight into the added content, floats in
+		//       the shortest form that reads back to the same value
+		void Add(std::string_view key, int32_t value);
+		void Add(std::string_view key, size_t value);
+		void Add(std::string_view key, float value);
+		// NOTE: Writes a parenthesised list like "(1,2.5,3)", see ReadTuple
+		void AddTuple(std::string_view key, const float* values, size_t count);
 
 		void Write(IO::Writer& writer);
+		// NOTE: Number of bytes Write will output
+		size_t GetWriteSize() const;
 	private:
 		struct RangeMarkup
 		{
@@ -71,9 +124,35 @@ namespace Property
 			size_t ValueSize = 0;
 		};
 
+		// NOTE: Open addressing hash table over mRanges, built once after parsing
+		struct IndexSlot
+		{
+			uint64_t Hash = 0;
+			size_t Index = SIZE_MAX;
+		};
+
 		std::string mContent;
 		std::vector<KeyValue> mRanges;
-		// NOTE: This is used for writing (until I find a better solution)
+		std::vector<IndexSlot> mIndex;
+
+		struct ScopeNode
+		{
+			std::string_view Name;
+			// NOTE: Full dotted path, points into the key that created the node
+			std::string_view Path;
+			ScopeHandle Parent = InvalidScope;
+			size_t Depth = 0;
+			ScopeHandle FirstChild = 0;
+			size_t ChildCount = 0;
+			size_t ArrayCount = 0;
+			size_t Value = SIZE_MAX;
+		};
+
+		std::vector<ScopeNode> mScopeNodes;
+
+		// NOTE: Used for writing. Offsets into mAddedContent stay valid when
+		//       it reallocates, unlike views
+		std::string mAddedContent;
 		std::vector<RangeMarkup> mRangeMarkups;
 
 		// NOTE: Using char array instead of std::string for this because
@@ -82,24 +161,23 @@ namespace Property
 		//       erase scope paths)
 		char mScope[0x80] = { '\0' };
 		std::vector<int32_t> mScopeStepStack;
-
-		size_t mPosition = 0;
-		inline std::string_view GetNextLine()
-		{
-			char* begin = &mContent[mPosition];
-			char* end = strchr(begin, '\n');
-			if (end == nullptr)
-			{
-				size_t remaining = mContent.size() - mPosition + 1;
-				mPosition += remaining;
-				return std::string_view(begin, remaining);
-			}
-
-			size_t size = static_cast<size_t>(end - begin) + 1;
-			mPosition += size;
-			return std::string_view(begin, size);
-		}
-
-		void Rearrange();
+		// NOTE: Tree node of each opened scope, InvalidScope without a tree
+		//       or when nothing was parsed under it
+		std::vector<ScopeHandle> mScopeNodeStack;
+
+		void ParseLines(const char* data, size_t size);
+		void AddLine(const char* data, size_t begin, size_t separator, size_t end);
+		void BuildIndex();
+		bool AppendScope(std::string_view scope);
+		template <typename Fn>
+		const KeyValue* FindInIndex(uint64_t hash, Fn&& matches) const;
+		void ResolveMarkups(std::vector<KeyValue>& ranges) const;
+		RangeMarkup AppendKey(std::string_view key);
+		void AppendNumber(int32_t value);
+		void AppendNumber(size_t value);
+		void AppendNumber(float value);
+
+		static bool ParseTuple(std::string_view src, int32_t* values, size_t capacity, size_t& count);
+		static bool ParseTuple(std::string_view src, float* values, size_t capacity, size_t& count);
 	};
 }
@@ -1,202 +1,115 @@
 
 #include "pch.h"
 #include "half.h"
+#include "core.h"
 
-#define CONVERT_PATTERN( x )  ( reinterpret_cast<UINT32 *>( &x ) )
-
-FLOAT16::FLOAT16() : m_uiFormat(0) {}
-
-FLOAT16::FLOAT16( CONST FLOAT16 & rhs ) : m_uiFormat( rhs.m_uiFormat ) {}
-
-FLOAT16::FLOAT16( CONST FLOAT32 & rhs )
-{
-    (*this) = rhs;
-}
-
-FLOAT16::~FLOAT16() {}
-
-FLOAT16::operator FLOAT32()
-{
-    return ToFloat32( *this );
-}
-
-FLOAT16 & FLOAT16::operator = ( CONST FLOAT16 & rhs )
-{
-    m_uiFormat = rhs.m_uiFormat;
-
-    return (*this);
-}
+#include <string.h>
 
-FLOAT16 & FLOAT16::operator = ( CONST FLOAT32 & rhs )
-{
-    (*this) = ToFloat16( rhs );
-
-    return (*this);
-}
+#ifdef DIVALIB_SSE2
+#include <emmintrin.h>
+#endif
 
-bool FLOAT16::operator == ( CONST FLOAT16 & rhs ) CONST
-{
-    return m_uiFormat == rhs.m_uiFormat;
-}
-
-bool FLOAT16::operator != ( CONST FLOAT16 & rhs ) CONST
-{
-    return !( (*this) == rhs );
-}
+#define CONVERT_PATTERN( x )  ( reinterpret_cast<UINT32 *>( &x ) )
 
-FLOAT32 FLOAT16::ToFloat32( FLOAT16 rhs )
+void FLOAT16::ToFloat32Array( CONST UINT16 * pInput, FLOAT32 * pOutput, size_t uiCount )
 {
-    FLOAT32 fOutput   = 0;                                  // floating point result
-    UINT32 * uiOutput = CONVERT_PATTERN( fOutput );         // bit manipulated output
-
-    if ( 0 == rhs.m_uiFormat )           return 0.0f;       // +zero
-    else if ( 0x8000 == rhs.m_uiFormat ) return -0.0f;      // -zero
-
-    UINT32 uiHalfSignBit   = GET_HALF_SIGN_BIT( rhs.m_uiFormat );
-    UINT32 uiHalfMantBits  = GET_HALF_MANT_BITS( rhs.m_uiFormat ) << 13;
-     INT32  iHalfExpBits   = GET_HALF_EXP_BITS( rhs.m_uiFormat );
+    size_t i = 0;
 
+#ifdef DIVALIB_SSE2
     //
-    // Next we check for additional special cases:
+    // Same steps as HalfToSingleBits, 8 values at a time
     //
 
-    if ( 0 == iHalfExpBits )
-    {
-        //
-        // Denormalized values
-        //
+    CONST __m128i zero     = _mm_setzero_si128();
+    CONST __m128i signMask = _mm_set1_epi32( HALF_SIGN_MASK );
+    CONST __m128i mantMask = _mm_set1_epi32( HALF_MANT_MASK );
+    CONST __m128i expMask  = _mm_set1_epi32( 0x1F );
+    CONST __m128i expBias  = _mm_set1_epi32( 127 - 15 );
+    CONST __m128i expMax   = _mm_set1_epi32( 0xFF );
 
-        SET_SINGLE_SIGN_BIT( uiHalfSignBit, (*uiOutput) );
-        SET_SINGLE_EXP_BITS( 0, (*uiOutput) );
-        SET_SINGLE_MANT_BITS( uiHalfMantBits, (*uiOutput) );
-    }
-
-    else if ( 0x1F == iHalfExpBits )
+    for ( ; i + 8 <= uiCount; i += 8 )
     {
-        if ( 0 == uiHalfMantBits )
-        {
-            //
-            // +- Infinity
-            //
+        __m128i halves = _mm_loadu_si128( reinterpret_cast<CONST __m128i *>( &pInput[i] ) );
+        __m128i parts[2] = { _mm_unpacklo_epi16( halves, zero ), _mm_unpackhi_epi16( halves, zero ) };
 
-            (*uiOutput) = ( uiHalfSignBit ? SINGLE_NEG_INFINITY : SINGLE_POS_INFINITY );
-        }
-        else
+        for ( int j = 0; j < 2; j++ )
         {
-            //
-            // (S/Q)NaN
-            //
+            __m128i value = parts[j];
+            __m128i exp   = _mm_and_si128( _mm_srli_epi32( value, HALF_EXP_SHIFT ), expMask );
+            __m128i isMin = _mm_cmpeq_epi32( exp, zero );
+            __m128i isMax = _mm_cmpeq_epi32( exp, expMask );
+
+            __m128i singleExp = _mm_andnot_si128( isMin, _mm_add_epi32( exp, expBias ) );
+            singleExp = _mm_or_si128( _mm_and_si128( isMax, expMax ), _mm_andnot_si128( isMax, singleExp ) );
 
-            SET_SINGLE_SIGN_BIT( uiHalfSignBit, (*uiOutput) );
-            SET_SINGLE_EXP_BITS( 0xFF, (*uiOutput) );
-            SET_SINGLE_MANT_BITS( uiHalfMantBits, (*uiOutput) );
+            __m128i result = _mm_slli_epi32( _mm_and_si128( value, signMask ), 16 );
+            result = _mm_or_si128( result, _mm_slli_epi32( singleExp, SINGLE_EXP_SHIFT ) );
+            result = _mm_or_si128( result, _mm_slli_epi32( _mm_and_si128( value, mantMask ), 13 ) );
+
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( &pOutput[i + j * 4] ), result );
         }
     }
+#endif
 
-    else
+    for ( ; i < uiCount; i++ )
     {
-        //
-        // Normalized values
-        //
-
-        SET_SINGLE_SIGN_BIT( uiHalfSignBit, (*uiOutput) );
-        SET_SINGLE_EXP_BITS( ( iHalfExpBits - 15 ) + 127, (*uiOutput) );
-        SET_SINGLE_MANT_BITS( uiHalfMantBits, (*uiOutput) );
+        UINT32 uiOutput = HalfToSingleBits( pInput[i] );
+        memcpy( &pOutput[i], &uiOutput, sizeof( FLOAT32 ) );
     }
-
-    //
-    // ATP: uiOutput equals the bit pattern of our floating point result.
-    //
-
-    return fOutput;
 }
 
-FLOAT16 FLOAT16::ToFloat16( FLOAT32 rhs )
+void FLOAT16::ToFloat16Array( CONST FLOAT32 * pInput, UINT16 * pOutput, size_t uiCount )
 {
-    //
-    // (!) Truncation will occur for values outside the representable range for float16.
-    //   
-
-    FLOAT16 fOutput;
-    UINT32 uiInput  = *CONVERT_PATTERN( rhs );
-
-    if ( 0.0f == rhs ) 
-    { 
-        fOutput.m_uiFormat = 0; 
-        return fOutput;
-    }
-     
-    else if ( -0.0f == rhs )
-    {
-        fOutput.m_uiFormat = 0x8000; 
-        return fOutput;
-    }
-
-    UINT32 uiSignBit   = GET_SINGLE_SIGN_BIT( uiInput );
-    UINT32 uiMantBits  = GET_SINGLE_MANT_BITS( uiInput ) >> 13;
-     INT32  iExpBits   = GET_SINGLE_EXP_BITS( uiInput );
+    size_t i = 0;
 
+#ifdef DIVALIB_SSE2
     //
-    // Next we check for additional special cases:
+    // Same steps as SingleToHalfBits, 8 values at a time. The exponent fits in
+    // 16 bits, so the SSE2 16-bit min/max can clamp it
     //
 
-    if ( 0 == iExpBits )
-    {
-        //
-        // Denormalized values
-        //
-
-        SET_HALF_SIGN_BIT( uiSignBit, fOutput.m_uiFormat );
-        SET_HALF_EXP_BITS( 0, fOutput.m_uiFormat );
-        SET_HALF_MANT_BITS( uiMantBits, fOutput.m_uiFormat );
-    }
+    CONST __m128i zero     = _mm_setzero_si128();
+    CONST __m128i absMask  = _mm_set1_epi32( ~SINGLE_SIGN_MASK );
+    CONST __m128i signMask = _mm_set1_epi32( HALF_SIGN_MASK );
+    CONST __m128i mantMask = _mm_set1_epi32( HALF_MANT_MASK );
+    CONST __m128i expMask  = _mm_set1_epi32( 0xFF );
+    CONST __m128i expBias  = _mm_set1_epi32( 127 - 15 );
+    CONST __m128i expMax   = _mm_set1_epi32( 31 );
 
-    else if ( 0xFF == iExpBits )
+    for ( ; i + 8 <= uiCount; i += 8 )
     {
-        if ( 0 == uiMantBits )
-        {
-            //
-            // +- Infinity
-            //
+        __m128i parts[2];
 
-            fOutput.m_uiFormat = ( uiSignBit ? HALF_NEG_INFINITY : HALF_POS_INFINITY );
-        }
-        else
+        for ( int j = 0; j < 2; j++ )
         {
-            //
-            // (S/Q)NaN
-            //
+            __m128i value = _mm_loadu_si128( reinterpret_cast<CONST __m128i *>( &pInput[i + j * 4] ) );
+            __m128i exp   = _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( value, SINGLE_EXP_SHIFT ), expMask ), expBias );
+            exp = _mm_min_epi16( _mm_max_epi16( exp, zero ), expMax );
 
-            SET_HALF_SIGN_BIT( uiSignBit, fOutput.m_uiFormat );
-            SET_HALF_EXP_BITS( 0x1F, fOutput.m_uiFormat );
-            SET_HALF_MANT_BITS( uiMantBits, fOutput.m_uiFormat );
-        }
-    }
+            __m128i result = _mm_and_si128( _mm_srli_epi32( value, 16 ), signMask );
+            result = _mm_or_si128( result, _mm_slli_epi32( exp, HALF_EXP_SHIFT ) );
+            result = _mm_or_si128( result, _mm_and_si128( _mm_srli_epi32( value, 13 ), mantMask ) );
 
-    else
-    {
-        //
-        // Normalized values
-        //
+            // Both zeros become +zero
+            __m128i isZero = _mm_cmpeq_epi32( _mm_and_si128( value, absMask ), zero );
+            result = _mm_andnot_si128( isZero, result );
 
-        INT32 iExponent = iExpBits - 127 + 15;
+            // Sign extend so the saturating pack keeps all 16 bits
+            parts[j] = _mm_srai_epi32( _mm_slli_epi32( result, 16 ), 16 );
+        }
 
-        if ( iExponent < 0 ) { iExponent = 0; }
-        else if ( iExponent > 31 ) iExponent = 31;
-            
-        SET_HALF_SIGN_BIT( uiSignBit, fOutput.m_uiFormat );
-        SET_HALF_EXP_BITS( iExponent, fOutput.m_uiFormat );
-        SET_HALF_MANT_BITS( uiMantBits, fOutput.m_uiFormat );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( &pOutput[i] ), _mm_packs_epi32( parts[0], parts[1] ) );
     }
+#endif
 
-    //
-    // ATP: uiOutput equals the bit pattern of our floating point result.
-    //
-
-    return fOutput;
+    for ( ; i < uiCount; i++ )
+    {
+        UINT32 uiInput = 0;
+        memcpy( &uiInput, &pInput[i], sizeof( FLOAT32 ) );
+        pOutput[i] = static_cast<UINT16>( SingleToHalfBits( uiInput ) );
+    }
 }
 
-
 FLOAT32 FLOAT16::ToFloat32Fast( FLOAT16 rhs )
 {
     FLOAT32 fOutput   = 0;                                  // floating point result
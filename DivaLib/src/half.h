@@ -27,6 +27,9 @@
 #ifndef __HALF_H__
 #define __HALF_H__
 
+#include <stddef.h>
+#include "core.h"
+
 typedef unsigned short                  UINT16;
 typedef unsigned int                    UINT32;
 typedef short                           INT16;
@@ -90,10 +93,9 @@ class FLOAT16
 
 public:
 
-    FLOAT16();
-    FLOAT16( CONST FLOAT16 & rhs );
-    FLOAT16( CONST FLOAT32 & rhs );
-    ~FLOAT16();
+    constexpr FLOAT16() : m_uiFormat( 0 ) {}
+    constexpr FLOAT16( CONST FLOAT16 & rhs ) : m_uiFormat( rhs.m_uiFormat ) {}
+    constexpr FLOAT16( CONST FLOAT32 & rhs ) : m_uiFormat( ToFloat16( rhs ).m_uiFormat ) {}
 
     //
     // Member operations
@@ -103,18 +105,26 @@ public:
     //           not provide any arithmetic operators.
     //
 
-    bool      operator == ( CONST FLOAT16 & rhs ) CONST;
-    bool      operator != ( CONST FLOAT16 & rhs ) CONST;
-    FLOAT16 & operator = ( CONST FLOAT16 & rhs );
-    FLOAT16 & operator = ( CONST FLOAT32 & rhs );
-              operator FLOAT32();
+    constexpr bool      operator == ( CONST FLOAT16 & rhs ) CONST { return m_uiFormat == rhs.m_uiFormat; }
+    constexpr bool      operator != ( CONST FLOAT16 & rhs ) CONST { return !( (*this) == rhs ); }
+    constexpr FLOAT16 & operator = ( CONST FLOAT16 & rhs ) { m_uiFormat = rhs.m_uiFormat; return (*this); }
+    constexpr FLOAT16 & operator = ( CONST FLOAT32 & rhs ) { (*this) = ToFloat16( rhs ); return (*this); }
+    constexpr           operator FLOAT32() CONST { return ToFloat32( *this ); }
 
     //
-    // Conversion control
+    // Raw bit pattern access, for storage and precomputed tables
     //
 
-    static FLOAT32 ToFloat32( FLOAT16 rhs );
-    static FLOAT16 ToFloat16( FLOAT32 rhs );    
+    constexpr UINT16 GetBits() CONST { return m_uiFormat; }
+    static constexpr FLOAT16 FromBits( UINT16 uiBits ) { FLOAT16 fOutput; fOutput.m_uiFormat = uiBits; return fOutput; }
+
+    //
+    // Conversion control. Usable in constant expressions, so tables of half
+    // values can be built at compile time.
+    //
+
+    static constexpr FLOAT32 ToFloat32( FLOAT16 rhs );
+    static constexpr FLOAT16 ToFloat16( FLOAT32 rhs );    
 
     //
     // The faster variants handle only the most common normalized conversion case.
@@ -124,6 +134,59 @@ public:
 
     static FLOAT32 ToFloat32Fast( FLOAT16 rhs );
     static FLOAT16 ToFloat16Fast( FLOAT32 rhs );    
+
+    //
+    // Batch conversion of raw half bit patterns. Results are bit-exact with
+    // ToFloat32 and ToFloat16, but several values are converted at once.
+    //
+
+    static void ToFloat32Array( CONST UINT16 * pInput, FLOAT32 * pOutput, size_t uiCount );
+    static void ToFloat16Array( CONST FLOAT32 * pInput, UINT16 * pOutput, size_t uiCount );
+
+private:
+
+    //
+    // Bit level conversion shared by the single value and batch functions. Mantissas
+    // are truncated, exponents are clamped to the target range and both zeros become
+    // +zero when going to half. Infinity and NaN fall out of the exponent clamping.
+    //
+
+    static constexpr UINT32 HalfToSingleBits( UINT32 uiHalf );
+    static constexpr UINT32 SingleToHalfBits( UINT32 uiSingle );
 };
 
+constexpr UINT32 FLOAT16::HalfToSingleBits( UINT32 uiHalf )
+{
+    UINT32 uiExpBits = GET_HALF_EXP_BITS( uiHalf );
+    UINT32 uiSingleExp = ( 0 == uiExpBits ) ? 0 : ( 0x1F == uiExpBits ) ? 0xFF : ( uiExpBits - 15 ) + 127;
+
+    return ( ( uiHalf & HALF_SIGN_MASK ) << 16 ) | ( uiSingleExp << SINGLE_EXP_SHIFT ) | ( GET_HALF_MANT_BITS( uiHalf ) << 13 );
+}
+
+constexpr UINT32 FLOAT16::SingleToHalfBits( UINT32 uiSingle )
+{
+    if ( 0 == ( uiSingle & ~SINGLE_SIGN_MASK ) ) return 0;   // +-zero
+
+    INT32 iExponent = static_cast<INT32>( GET_SINGLE_EXP_BITS( uiSingle ) ) - 127 + 15;
+
+    if ( iExponent < 0 ) { iExponent = 0; }
+    else if ( iExponent > 31 ) iExponent = 31;
+
+    return ( ( uiSingle >> 16 ) & HALF_SIGN_MASK ) | ( static_cast<UINT32>( iExponent ) << HALF_EXP_SHIFT ) | ( GET_SINGLE_MANT_BITS( uiSingle ) >> 13 );
+}
+
+constexpr FLOAT32 FLOAT16::ToFloat32( FLOAT16 rhs )
+{
+    return BitCast<FLOAT32>( HalfToSingleBits( rhs.m_uiFormat ) );
+}
+
+constexpr FLOAT16 FLOAT16::ToFloat16( FLOAT32 rhs )
+{
+    //
+    // (!) Truncation will occur for values outside the representable range for float16.
+    //   
+
+    return FromBits( static_cast<UINT16>( SingleToHalfBits( BitCast<UINT32>( rhs ) ) ) );
+}
+
 #endif // __HALF_H__
@@ -10,6 +10,8 @@
 #include <string_view>
 #include <utility>
 #include <vector>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 #endif
@@ -1,34 +1,93 @@
 #include "pch.h"
 #include "util_string.h"
+#include "core.h"
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef DIVALIB_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// NOTE: Index of the highest set bit, mask must not be zero
+static inline int32_t GetHighestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index = 0;
+	_BitScanReverse(&index, mask);
+	return static_cast<int32_t>(index);
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
 
 int32_t Util::String::GetIndex(std::string_view str, char seek)
 {
-	for (size_t i = 0; i < str.size(); i++)
-		if (str[i] == seek)
-			return i;
+	if (str.empty())
+		return -1;
 
-	return -1;
+	const void* found = memchr(str.data(), seek, str.size());
+	return found != nullptr ? static_cast<int32_t>(static_cast<const char*>(found) - str.data()) : -1;
 }
 
 int32_t Util::String::GetLastIndex(std::string_view str, char seek)
 {
-	if (str.empty())
-		return -1;
+	const char* data = str.data();
+	size_t i = str.size();
+
+#ifdef DIVALIB_SSE2
+	// NOTE: Scan backwards 16 characters at a time, the last match is the highest bit
+	const __m128i needle = _mm_set1_epi8(seek);
+	while (i >= 16)
+	{
+		i -= 16;
+		__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i]));
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, needle)));
+		if (mask != 0)
+			return static_cast<int32_t>(i) + GetHighestBit(mask);
+	}
+#endif
 
-	int32_t index = -1;
-	for (size_t i = 0; i < str.size(); i++)
-		if (str[i] == seek)
-			index = static_cast<int32_t>(i);
+	while (i-- > 0)
+		if (data[i] == seek)
+			return static_cast<int32_t>(i);
 
-	return index;
+	return -1;
 }
 
 int32_t Util::String::Count(std::string_view str, char seek)
 {
+	const char* data = str.data();
+	size_t size = str.size();
+	size_t i = 0;
 	int32_t count = 0;
 
-	for (const char& c : str)
-		if (c == seek)
+#ifdef DIVALIB_SSE2
+	// NOTE: Matches are -1, so subtracting them counts per byte lane. The lanes
+	//       overflow after 255 blocks, so they're summed up before that
+	const __m128i needle = _mm_set1_epi8(seek);
+	const __m128i zero = _mm_setzero_si128();
+	while (i + 16 <= size)
+	{
+		size_t blocks = std::min<size_t>((size - i) / 16, 255);
+		__m128i counts = zero;
+		for (size_t block = 0; block < blocks; block++, i += 16)
+		{
+			__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i]));
+			counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(chars, needle));
+		}
+
+		__m128i sums = _mm_sad_epu8(counts, zero);
+		count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+	}
+#endif
+
+	for (; i < size; i++)
+		if (data[i] == seek)
 			count++;
 
 	return count;
@@ -36,8 +95,29 @@ int32_t Util::String::Count(std::string_view str, char seek)
 
 std::string Util::String::ToLower(std::string_view str)
 {
-	std::string lower;
-	for (const char& c : str)
-		lower += tolower(c);
-	return std::move(lower);
-}
\ No newline at end of file
+	std::string lower(str.size(), '\0');
+	char* out = lower.data();
+	size_t i = 0;
+
+#ifdef DIVALIB_SSE2
+	// NOTE: Moves 'A'-'Z' to the bottom of the signed range,
+	//       so a single compare finds all uppercase letters
+	const __m128i offset = _mm_set1_epi8(static_cast<char>(0x80 - 'A'));
+	const __m128i limit = _mm_set1_epi8(static_cast<char>(0x80 + 26));
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	for (; i + 16 <= str.size(); i += 16)
+	{
+		__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&str[i]));
+		__m128i upper = _mm_cmplt_epi8(_mm_add_epi8(chars, offset), limit);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_or_si128(chars, _mm_and_si128(upper, caseBit)));
+	}
+#endif
+
+	for (; i < str.size(); i++)
+	{
+		const unsigned char c = static_cast<unsigned char>(str[i]);
+		out[i] = static_cast<char>(c | (static_cast<unsigned char>(c - 'A') < 26) << 5);
+	}
+
+	return lower;
+}
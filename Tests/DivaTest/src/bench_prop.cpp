@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <core_io.h>
+#include <diva_prop.h>
+#include "tests.h"
+
+// NOTE: A3DA key data formatting, the old sprintf path against AddTuple
+static void BenchmarkKeyFormatting()
+{
+    constexpr int32_t KeyCount = 400000;
+    std::vector<float> keys(KeyCount * 4);
+    for (int32_t i = 0; i < KeyCount; i++)
+    {
+        keys[i * 4 + 0] = static_cast<float>(i);
+        keys[i * 4 + 1] = i * 0.37f;
+        keys[i * 4 + 2] = 1.0f / (i + 1);
+        keys[i * 4 + 3] = -0.25f;
+    }
+
+    double sprintfTime = Tests::MeasureBestMilliseconds(3, [&]()
+    {
+        Property::CanonicalProperties prop;
+        char buffer[0x40];
+        for (int32_t i = 0; i < KeyCount; i++)
+        {
+            const float* key = &keys[i * 4];
+            snprintf(buffer, sizeof(buffer), "(%f,%f,%f,%f)", key[0], key[1], key[2], key[3]);
+            prop.Add("data", buffer);
+        }
+    });
+
+    double toCharsTime = Tests::MeasureBestMilliseconds(3, [&]()
+    {
+        Property::CanonicalProperties prop;
+        for (int32_t i = 0; i < KeyCount; i++)
+            prop.AddTuple("data", &keys[i * 4], 4);
+    });
+
+    printf("Key formatting (%d keys): sprintf %.1f ms, AddTuple %.1f ms\n", KeyCount, sprintfTime, toCharsTime);
+}
+
+// NOTE: The way Add used to work, every append re-pointed the views of all
+//       entries at the (possibly moved) content, so N entries took O(N^2)
+class RepointingProperties
+{
+public:
+    void Add(std::string_view scope, std::string_view key, std::string_view value)
+    {
+        Markup& mark = mMarkups.emplace_back();
+        mark.KeyOffset = mContent.size();
+        mContent += scope;
+        mContent += '.';
+        mContent += key;
+        mark.KeySize = mContent.size() - mark.KeyOffset;
+        mark.ValueOffset = mContent.size();
+        mContent += value;
+        mark.ValueSize = value.size();
+
+        mRanges.emplace_back();
+        for (size_t i = 0; i < mRanges.size(); i++)
+        {
+            mRanges[i].first = std::string_view(mContent.data() + mMarkups[i].KeyOffset, mMarkups[i].KeySize);
+            mRanges[i].second = std::string_view(mContent.data() + mMarkups[i].ValueOffset, mMarkups[i].ValueSize);
+        }
+    }
+
+    void Write(IO::Writer& writer)
+    {
+        std::sort(mRanges.begin(), mRanges.end());
+        for (const auto& range : mRanges)
+        {
+            writer.Write(range.first.data(), range.first.size());
+            writer.WriteChar('=');
+            writer.Write(range.second.data(), range.second.size());
+            writer.WriteChar('\n');
+        }
+    }
+private:
+    struct Markup
+    {
+        size_t KeyOffset, KeySize, ValueOffset, ValueSize;
+    };
+
+    std::string mContent;
+    std::vector<Markup> mMarkups;
+    std::vector<Property::KeyValue> mRanges;
+};
+
+// NOTE: Adds entries under one scope and writes them, like Auth3D::Write
+static void BenchmarkAddAndWrite(int32_t entryCount)
+{
+    constexpr const char* Scope = "camera_root.0.view_point.trans.x";
+    char key[0x20];
+
+    double repointingTime = Tests::MeasureBestMilliseconds(1, [&]()
+    {
+        RepointingProperties prop;
+        for (int32_t i = 0; i < entryCount; i++)
+        {
+            snprintf(key, sizeof(key), "key.%d.data", i);
+            prop.Add(Scope, key, "(1,2.5)");
+        }
+
+        IO::Writer writer;
+        prop.Write(writer);
+    });
+
+    double appendTime = Tests::MeasureBestMilliseconds(3, [&]()
+    {
+        Property::CanonicalProperties prop;
+        prop.OpenScope(Scope);
+        for (int32_t i = 0; i < entryCount; i++)
+        {
+            snprintf(key, sizeof(key), "key.%d.data", i);
+            prop.Add(key, "(1,2.5)");
+        }
+        prop.CloseScope();
+
+        IO::Writer writer;
+        prop.Write(writer);
+    });
+
+    printf("Add and Write (%d keys): re-pointing views %.1f ms, append-only %.1f ms\n", entryCount, repointingTime, appendTime);
+}
+
+void Tests::RunPropertyBenchmarks()
+{
+    BenchmarkKeyFormatting();
+    BenchmarkAddAndWrite(10000);
+    BenchmarkAddAndWrite(100000);
+}
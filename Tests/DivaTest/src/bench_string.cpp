@@ -0,0 +1,74 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <util_string.h>
+#include "tests.h"
+
+// NOTE: Plain byte loops, the way these helpers used to be written
+static int32_t GetIndexBytewise(std::string_view str, char seek)
+{
+    for (size_t i = 0; i < str.size(); i++)
+        if (str[i] == seek)
+            return static_cast<int32_t>(i);
+    return -1;
+}
+
+static int32_t GetLastIndexBytewise(std::string_view str, char seek)
+{
+    int32_t index = -1;
+    for (size_t i = 0; i < str.size(); i++)
+        if (str[i] == seek)
+            index = static_cast<int32_t>(i);
+    return index;
+}
+
+static int32_t CountBytewise(std::string_view str, char seek)
+{
+    int32_t count = 0;
+    for (char c : str)
+        if (c == seek)
+            count++;
+    return count;
+}
+
+static std::string ToLowerBytewise(std::string_view str)
+{
+    std::string lower;
+    for (char c : str)
+        lower += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return lower;
+}
+
+using StringTask = size_t(*)(std::string_view);
+
+static void Compare(const char* name, std::string_view text, StringTask bytewise, StringTask library)
+{
+    // NOTE: The results are kept so the loops can't be optimized out
+    volatile size_t sink = 0;
+    double bytewiseTime = Tests::MeasureBestMilliseconds(10, [&]() { sink = sink + bytewise(text); });
+    double libraryTime = Tests::MeasureBestMilliseconds(10, [&]() { sink = sink + library(text); });
+    TEST_CHECK(bytewise(text) == library(text));
+
+    printf("%-14s byte loop %6.2f ms, Util::String %6.2f ms\n", name, bytewiseTime, libraryTime);
+}
+
+// NOTE: 10 MB of A3DA-style lines. '#' never appears, so the searches scan everything
+void Tests::RunStringBenchmarks()
+{
+    std::string text;
+    for (int32_t i = 0; i < 200000; i++)
+        text += "objhrc.0.node.12.trans.x.key.3.data=(1.000000,2.5)\n";
+    Compare("Count", text,
+        [](std::string_view str) { return static_cast<size_t>(CountBytewise(str, '.')); },
+        [](std::string_view str) { return static_cast<size_t>(Util::String::Count(str, '.')); });
+    Compare("GetLastIndex", text,
+        [](std::string_view str) { return static_cast<size_t>(GetLastIndexBytewise(str, '#')); },
+        [](std::string_view str) { return static_cast<size_t>(Util::String::GetLastIndex(str, '#')); });
+    Compare("GetIndex", text,
+        [](std::string_view str) { return static_cast<size_t>(GetIndexBytewise(str, '#')); },
+        [](std::string_view str) { return static_cast<size_t>(Util::String::GetIndex(str, '#')); });
+    Compare("ToLower", text,
+        [](std::string_view str) { return std::hash<std::string>()(ToLowerBytewise(str)); },
+        [](std::string_view str) { return std::hash<std::string>()(Util::String::ToLower(str)); });
+}
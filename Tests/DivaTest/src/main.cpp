@@ -1,11 +1,16 @@
+#include <string.h>
 #include <core_io.h>
 #include <diva_auth2d.h>
 #include <diva_archive.h>
+#include "tests.h"
+
+int32_t Tests::FailureCount = 0;
 
 const char* AetFilename = "C:\\Development\\aet_gam_pv637.bin";
-const char FileData[1672 * 1024] = { 0xCC };
+const char FileData[1672 * 1024] = { static_cast<char>(0xCC) };
 
-int main(int argc, char** argv)
+// NOTE: Round trip of local files, only run with -smoke
+static void RunSmokeTest()
 {
     IO::Reader reader;
     reader.FromFile(AetFilename);
@@ -17,6 +22,44 @@ int main(int argc, char** argv)
     packer.AddFile(file);
 
     packer.Flush("C:\\Development\\new_test.farc", false);
+}
+
+int main(int argc, char** argv)
+{
+    bool smoke = false;
+    bool benchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-smoke") == 0)
+            smoke = true;
+        else if (strcmp(argv[i], "-bench") == 0)
+            benchmark = true;
+    }
+
+    if (smoke)
+    {
+        RunSmokeTest();
+        return 0;
+    }
+
+    Tests::RunHalfTests();
+    Tests::RunEndianTests();
+    Tests::RunPropertyTests();
+    Tests::RunWriterTests();
+
+    // NOTE: Timings only mean something in release builds
+    if (benchmark)
+    {
+        Tests::RunPropertyBenchmarks();
+        Tests::RunStringBenchmarks();
+    }
+
+    if (Tests::FailureCount > 0)
+    {
+        printf("%d check(s) failed\n", Tests::FailureCount);
+        return 1;
+    }
 
+    puts("All tests passed");
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,61 @@
+#include <string.h>
+#include <core_io.h>
+#include "tests.h"
+
+// NOTE: Compares the vectorized array swaps with Endian::Swap on every length
+//       up to a few vectors and every byte alignment, so the scalar tails and
+//       unaligned loads are covered. Bytes around the array must stay untouched
+template <typename T, typename Fn>
+static int32_t CountSwapArrayMismatches(Fn&& swapArray)
+{
+    constexpr size_t MaxCount = 100;
+    constexpr size_t Guard = 16;
+    constexpr size_t BufferSize = Guard + 16 + MaxCount * sizeof(T) + Guard;
+
+    uint8_t source[BufferSize];
+    for (size_t i = 0; i < BufferSize; i++)
+        source[i] = static_cast<uint8_t>(i * 37 + 11);
+
+    int32_t mismatches = 0;
+    for (size_t offset = 0; offset < 16; offset++)
+    {
+        for (size_t count = 0; count <= MaxCount; count++)
+        {
+            uint8_t buffer[BufferSize];
+            memcpy(buffer, source, BufferSize);
+
+            uint8_t* data = &buffer[Guard + offset];
+            swapArray(data, count);
+
+            uint8_t expected[BufferSize];
+            memcpy(expected, source, BufferSize);
+            for (size_t i = 0; i < count; i++)
+            {
+                T value;
+                memcpy(&value, &expected[Guard + offset + i * sizeof(T)], sizeof(T));
+                value = IO::Endian::Swap(value);
+                memcpy(&expected[Guard + offset + i * sizeof(T)], &value, sizeof(T));
+            }
+
+            if (memcmp(buffer, expected, BufferSize) != 0)
+                mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+void Tests::RunEndianTests()
+{
+    TEST_CHECK(CountSwapArrayMismatches<uint16_t>(IO::Endian::SwapArray16) == 0);
+    TEST_CHECK(CountSwapArrayMismatches<uint32_t>(IO::Endian::SwapArray32) == 0);
+
+    // NOTE: The typed wrapper picks the kernel by element size
+    TEST_CHECK(CountSwapArrayMismatches<uint32_t>([](uint8_t* data, size_t count)
+    {
+        float values[100];
+        memcpy(values, data, count * sizeof(float));
+        IO::Endian::SwapArray(values, count);
+        memcpy(data, values, count * sizeof(float));
+    }) == 0);
+}
@@ -0,0 +1,116 @@
+#include <string.h>
+#include <vector>
+#include <half.h>
+#include "tests.h"
+
+// NOTE: The conversions are constexpr, so these have to hold at compile time too
+static_assert(FLOAT16::FromBits(0x3C00).ToFloat32(FLOAT16::FromBits(0x3C00)) == 1.0f, "half 1.0");
+static_assert(FLOAT16::ToFloat16(-2.0f).GetBits() == 0xC000, "half -2.0");
+static_assert(FLOAT16::ToFloat16(-0.0f).GetBits() == 0x0000, "half -0.0 becomes +0.0");
+static_assert(FLOAT16::ToFloat16(65504.0f).GetBits() == 0x7BFF, "half max");
+
+static uint32_t GetBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float FromBits(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// NOTE: Every half through the batch path, compared bit for bit with the scalar one
+static void TestHalfToFloat32()
+{
+    std::vector<UINT16> halfs(0x10000);
+    for (size_t i = 0; i < halfs.size(); i++)
+        halfs[i] = static_cast<UINT16>(i);
+
+    std::vector<FLOAT32> singles(halfs.size());
+    FLOAT16::ToFloat32Array(halfs.data(), singles.data(), halfs.size());
+
+    int32_t mismatches = 0;
+    for (size_t i = 0; i < halfs.size(); i++)
+        if (GetBits(singles[i]) != GetBits(FLOAT16::ToFloat32(FLOAT16::FromBits(halfs[i]))))
+            mismatches++;
+
+    TEST_CHECK(mismatches == 0);
+}
+
+// NOTE: Every single that is exactly a half, plus its neighbours (rounding
+//       and exponent edges), plus a stride through the whole 32-bit range
+static void TestFloat32ToHalf()
+{
+    std::vector<FLOAT32> singles;
+    for (uint32_t i = 0; i < 0x10000; i++)
+    {
+        uint32_t bits = GetBits(FLOAT16::ToFloat32(FLOAT16::FromBits(static_cast<UINT16>(i))));
+        singles.push_back(FromBits(bits - 1));
+        singles.push_back(FromBits(bits));
+        singles.push_back(FromBits(bits + 1));
+        singles.push_back(FromBits(bits | 0x1FFF));
+    }
+
+    for (uint64_t bits = 0; bits <= UINT32_MAX; bits += 0xFFF1)
+        singles.push_back(FromBits(static_cast<uint32_t>(bits)));
+
+    std::vector<UINT16> halfs(singles.size());
+    FLOAT16::ToFloat16Array(singles.data(), halfs.data(), singles.size());
+
+    int32_t mismatches = 0;
+    for (size_t i = 0; i < singles.size(); i++)
+        if (halfs[i] != FLOAT16::ToFloat16(singles[i]).GetBits())
+            mismatches++;
+
+    TEST_CHECK(mismatches == 0);
+}
+
+// NOTE: The vector loops handle several values at a time, so every short length
+//       and start offset is run to cover the scalar tails
+static void TestHalfArrayTails()
+{
+    UINT16 halfs[64];
+    FLOAT32 singles[64];
+    for (size_t i = 0; i < 64; i++)
+        halfs[i] = static_cast<UINT16>(0x3C00 + i * 0x155);
+
+    int32_t mismatches = 0;
+    for (size_t offset = 0; offset < 8; offset++)
+    {
+        for (size_t count = 0; count + offset <= 40; count++)
+        {
+            FLOAT32 toSingle[64];
+            UINT16 toHalf[64];
+            memset(toSingle, 0xCD, sizeof(toSingle));
+            memset(toHalf, 0xCD, sizeof(toHalf));
+
+            FLOAT16::ToFloat32Array(&halfs[offset], &toSingle[offset], count);
+            for (size_t i = 0; i < count; i++)
+                singles[offset + i] = FLOAT16::ToFloat32(FLOAT16::FromBits(halfs[offset + i]));
+            FLOAT16::ToFloat16Array(&singles[offset], &toHalf[offset], count);
+
+            for (size_t i = 0; i < 64; i++)
+            {
+                bool inside = i >= offset && i < offset + count;
+                uint32_t expectedSingle = inside ? GetBits(singles[i]) : 0xCDCDCDCD;
+                UINT16 expectedHalf = inside ? FLOAT16::ToFloat16(singles[i]).GetBits() : 0xCDCD;
+
+                if (GetBits(toSingle[i]) != expectedSingle || toHalf[i] != expectedHalf)
+                    mismatches++;
+            }
+        }
+    }
+
+    TEST_CHECK(mismatches == 0);
+}
+
+void Tests::RunHalfTests()
+{
+    TestHalfToFloat32();
+    TestFloat32ToHalf();
+    TestHalfArrayTails();
+}
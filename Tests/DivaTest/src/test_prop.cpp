@@ -0,0 +1,137 @@
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <core_io.h>
+#include <diva_prop.h>
+#include "tests.h"
+
+static uint32_t GetBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float FromBits(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// NOTE: Writes the properties out and parses them back, like saving and loading an A3DA
+static void Reparse(Property::CanonicalProperties& source, std::string& content, Property::CanonicalProperties& result)
+{
+    IO::Writer writer;
+    source.Write(writer);
+    content.assign(static_cast<const char*>(writer.GetData()), writer.GetSize());
+    result.Parse(content.data(), content.size());
+}
+
+// NOTE: Floats are written in their shortest round trip form, every value has
+//       to read back with the exact same bits. NaN payloads aren't kept, so
+//       NaNs are left out
+static void TestFloatRoundTrip()
+{
+    std::vector<float> values =
+    {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.1f, 1.0f / 3.0f, 1e-05f, 123456789.0f, 3.4028235e38f, -3.4028235e38f,
+        1.17549435e-38f, FromBits(0x00000001), FromBits(0x80000001), FromBits(0x007FFFFF), FromBits(0x00400000),
+        INFINITY, -INFINITY, 16777216.0f, 16777217.0f, 1e10f, 1e-10f, 65504.0f,
+    };
+
+    // NOTE: A stride through every sign, exponent (subnormals included) and mantissa
+    for (uint64_t bits = 0; bits <= UINT32_MAX; bits += 0x10001)
+    {
+        float value = FromBits(static_cast<uint32_t>(bits));
+        if (!isnan(value))
+            values.push_back(value);
+    }
+
+    Property::CanonicalProperties source;
+    char key[0x20];
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        snprintf(key, sizeof(key), "value.%zu", i);
+        source.Add(key, values[i]);
+
+        // NOTE: Tuples like A3DA key data, "(frame,value,t1,t2)"
+        const float tuple[] = { values[i], -values[i], values[values.size() - 1 - i], static_cast<float>(i) };
+        snprintf(key, sizeof(key), "tuple.%zu", i);
+        source.AddTuple(key, tuple, 4);
+    }
+
+    std::string content;
+    Property::CanonicalProperties result;
+    Reparse(source, content, result);
+
+    int32_t mismatches = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        float value = 0.0f;
+        snprintf(key, sizeof(key), "value.%zu", i);
+        if (!result.Read(key, value) || GetBits(value) != GetBits(values[i]))
+            mismatches++;
+
+        std::array<float, 4> tuple = { };
+        const float expected[] = { values[i], -values[i], values[values.size() - 1 - i], static_cast<float>(i) };
+        snprintf(key, sizeof(key), "tuple.%zu", i);
+        if (!result.ReadTuple(key, tuple) || memcmp(tuple.data(), expected, sizeof(expected)) != 0)
+            mismatches++;
+    }
+
+    TEST_CHECK(mismatches == 0);
+    TEST_CHECK(content.size() == source.GetWriteSize());
+}
+
+// NOTE: The shortest form switches to exponent notation when that is shorter
+static void TestFloatFormat()
+{
+    Property::CanonicalProperties source;
+    source.Add("a", 1.0f);
+    source.Add("b", 0.5f);
+    source.Add("c", 1e-05f);
+    source.Add("d", -0.0f);
+    const float tuple[] = { 10.0f, 0.1f, 1e20f };
+    source.AddTuple("e", tuple, 3);
+    source.Add("f", static_cast<int32_t>(INT32_MIN));
+    source.Add("g", static_cast<size_t>(42));
+
+    std::string content;
+    Property::CanonicalProperties result;
+    Reparse(source, content, result);
+
+    TEST_CHECK(content == "a=1\nb=0.5\nc=1e-05\nd=-0\ne=(10,0.1,1e+20)\nf=-2147483648\ng=42\n");
+}
+
+// NOTE: Lookups have to split keys the same way the tree was built, empty
+//       segments (e.g. a trailing '.') included
+static void TestScopeTreeSegments()
+{
+    const std::string content = "a.b=1\na.b.=2\na.c.0=3\na.c.1=4\na.c.length=2\n";
+    Property::CanonicalProperties prop;
+    prop.Parse(content.data(), content.size());
+    prop.BuildScopeTree();
+
+    const Property::ScopeHandle root = prop.GetRootScope();
+    const Property::ScopeHandle b = prop.FindScope(root, "a.b");
+    const Property::ScopeHandle bEmpty = prop.FindScope(root, "a.b.");
+
+    TEST_CHECK(b != Property::InvalidScope && prop.GetScopeValue(b)->second == "1");
+    TEST_CHECK(bEmpty != Property::InvalidScope && bEmpty != b && prop.GetScopeValue(bEmpty)->second == "2");
+    TEST_CHECK(prop.FindScope(root, "a.c.") == Property::InvalidScope);
+    TEST_CHECK(prop.FindScope(root, "a..c") == Property::InvalidScope);
+    TEST_CHECK(prop.FindScope(root, "") == root);
+
+    const Property::ScopeHandle c = prop.FindScope(root, "a.c");
+    TEST_CHECK(prop.GetArrayScopes(c).GetSize() == 2);
+    TEST_CHECK(prop.GetChildScopes(c).GetSize() == 3);
+}
+
+void Tests::RunPropertyTests()
+{
+    TestFloatRoundTrip();
+    TestFloatFormat();
+    TestScopeTreeSegments();
+}
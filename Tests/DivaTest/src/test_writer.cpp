@@ -0,0 +1,104 @@
+#include <string.h>
+#include <string>
+#include <vector>
+#include <core_io.h>
+#include <diva_db.h>
+#include "tests.h"
+
+// NOTE: Schedules an offset for each string, flushes them and returns
+//       the string each offset points at
+static std::vector<std::string> FlushStrings(const std::vector<std::string>& strings, IO::StringPooling pooling, size_t& size)
+{
+    IO::Writer writer;
+    for (const auto& str : strings)
+        writer.ScheduleWriteStringOffset(str);
+    writer.FlushScheduledStrings(pooling);
+
+    size = writer.GetSize();
+    const uint8_t* data = static_cast<const uint8_t*>(writer.GetData());
+
+    std::vector<std::string> result;
+    for (size_t i = 0; i < strings.size(); i++)
+    {
+        uint32_t offset;
+        memcpy(&offset, &data[i * sizeof(uint32_t)], sizeof(offset));
+        result.emplace_back(offset < size ? reinterpret_cast<const char*>(&data[offset]) : "<out of range>");
+    }
+
+    return result;
+}
+
+static void TestStringPooling()
+{
+    size_t size = 0;
+    for (auto pooling : { IO::StringPooling::None, IO::StringPooling::Duplicates, IO::StringPooling::Suffixes })
+    {
+        // NOTE: Flushing with nothing scheduled must not write anything
+        TEST_CHECK(FlushStrings({ }, pooling, size).empty() && size == 0);
+
+        const std::vector<std::string> single = { "SPR_SET" };
+        TEST_CHECK(FlushStrings(single, pooling, size) == single);
+        TEST_CHECK(size == sizeof(uint32_t) + single[0].size() + 1);
+    }
+
+    // NOTE: "NAME" and "E" live inside "SPR_NAME", "SPR_NAME" repeats, "OTHER" is separate
+    const std::vector<std::string> strings = { "NAME", "SPR_NAME", "OTHER", "SPR_NAME", "E", "" };
+    TEST_CHECK(FlushStrings(strings, IO::StringPooling::None, size) == strings);
+    TEST_CHECK(FlushStrings(strings, IO::StringPooling::Duplicates, size) == strings);
+    TEST_CHECK(FlushStrings(strings, IO::StringPooling::Suffixes, size) == strings);
+    TEST_CHECK(size == strings.size() * sizeof(uint32_t) + sizeof("SPR_NAME") + sizeof("OTHER"));
+}
+
+static bool RoundTrip(Database::SpriteDatabase& source, Database::SpriteDatabase& result)
+{
+    IO::Writer writer;
+    source.Write(writer);
+
+    std::vector<uint8_t> data(writer.GetSize());
+    memcpy(data.data(), writer.GetData(), data.size());
+
+    IO::Reader reader;
+    reader.FromMemory(data.data(), data.size());
+    return result.Parse(reader);
+}
+
+static void TestSpriteDatabaseRoundTrip()
+{
+    Database::SpriteDatabase empty, emptyResult;
+    TEST_CHECK(RoundTrip(empty, emptyResult) && emptyResult.SpriteSets.empty());
+
+    Database::SpriteDatabase source, result;
+    for (uint32_t s = 0; s < 3; s++)
+    {
+        auto& set = source.SpriteSets.emplace_back();
+        set.Id = 100 + s;
+        set.Name = "SPR_SET_" + std::to_string(s);
+        set.Filename = "spr_set_" + std::to_string(s) + ".bin";
+
+        for (int32_t i = 0; i < 4; i++)
+        {
+            auto& sprite = set.Sprites.emplace_back();
+            sprite.Id = s * 100 + i;
+            sprite.Name = i % 2 ? "SET_" + std::to_string(s) : "SPR_SET_" + std::to_string(s);
+            sprite.DataIndex = i;
+        }
+    }
+
+    TEST_CHECK(RoundTrip(source, result) && result.SpriteSets.size() == source.SpriteSets.size());
+    for (size_t s = 0; s < result.SpriteSets.size() && s < source.SpriteSets.size(); s++)
+    {
+        const auto& expected = source.SpriteSets[s];
+        const auto& actual = result.SpriteSets[s];
+        TEST_CHECK(actual.Id == expected.Id && actual.Name == expected.Name && actual.Filename == expected.Filename);
+        TEST_CHECK(actual.Sprites.size() == expected.Sprites.size());
+
+        for (size_t i = 0; i < actual.Sprites.size() && i < expected.Sprites.size(); i++)
+            TEST_CHECK(actual.Sprites[i].Id == expected.Sprites[i].Id && actual.Sprites[i].Name == expected.Sprites[i].Name);
+    }
+}
+
+void Tests::RunWriterTests()
+{
+    TestStringPooling();
+    TestSpriteDatabaseRoundTrip();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+namespace Tests
+{
+    // NOTE: Failed checks so far, main returns non-zero if there were any
+    extern int32_t FailureCount;
+
+    inline bool Check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (!condition)
+        {
+            printf("%s:%d: check failed: %s\n", file, line, expression);
+            FailureCount++;
+        }
+
+        return condition;
+    }
+
+    // NOTE: Wall time of a single call, benchmarks report the best of a few runs
+    template <typename Fn>
+    inline double MeasureMilliseconds(Fn&& task)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        task();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+
+    template <typename Fn>
+    inline double MeasureBestMilliseconds(int32_t runs, Fn&& task)
+    {
+        double best = MeasureMilliseconds(task);
+        for (int32_t i = 1; i < runs; i++)
+        {
+            double time = MeasureMilliseconds(task);
+            if (time < best)
+                best = time;
+        }
+
+        return best;
+    }
+
+    void RunHalfTests();
+    void RunEndianTests();
+    void RunPropertyTests();
+    void RunWriterTests();
+
+    void RunPropertyBenchmarks();
+    void RunStringBenchmarks();
+}
+
+#define TEST_CHECK(condition) Tests::Check((condition), #condition, __FILE__, __LINE__)
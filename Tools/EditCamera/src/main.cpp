@@ -148,7 +148,7 @@ static void OptimizeKeyframes(Auth::CameraRoot& cam)
 	OptimizeProperty3D(cam.ViewPoint.Translation);
 }
 
-static void WriteAuthSingleShot(const EditCameraInfo& camInfo, int32_t camIndex, int32_t id)
+static bool WriteAuthSingleShot(const EditCameraInfo& camInfo, int32_t camIndex, int32_t id)
 {
 	Auth::Auth3D a3d = { };
 	IO::Writer writer;
@@ -168,8 +168,20 @@ static void WriteAuthSingleShot(const EditCameraInfo& camInfo, int32_t camIndex,
 	a3d.PlayControl.Framerate = 60.0f;
 	a3d.PlayControl.Size = a3d.GetMaxFrame();
 
+	if (!writer.OpenStream(buffer))
+	{
+		printf("Failed to open output file: %s\n", buffer);
+		return false;
+	}
+
 	a3d.Write(writer);
-	writer.Flush(buffer);
+	if (!writer.CloseStream())
+	{
+		printf("Failed to write output file: %s\n", buffer);
+		return false;
+	}
+
+	return true;
 }
 
 int main(int argc, char** argv)
@@ -247,7 +259,10 @@ int main(int argc, char** argv)
 				const auto camInfo = FormatEditCamera(argBuffer);
 
 				if (!authStyleF)
-					WriteAuthSingleShot(camInfo, camIndex, id);
+				{
+					if (!WriteAuthSingleShot(camInfo, camIndex, id))
+						return -1;
+				}
 				else
 					AddAuthCamRootKey(camInfo, camRoot, (time - timeBegin) / 100.0f);
 
@@ -273,8 +288,18 @@ int main(int argc, char** argv)
 
 		// NOTE: Write Auth3D to file
 		IO::Writer writer;
+		if (!writer.OpenStream(filename))
+		{
+			printf("Failed to open output file: %s\n", filename);
+			return -1;
+		}
+
 		a3d.Write(writer);
-		writer.Flush(filename);
+		if (!writer.CloseStream())
+		{
+			printf("Failed to write output file: %s\n", filename);
+			return -1;
+		}
 	}
 
 	return 0;